@@ -0,0 +1,37 @@
+#version 330 core
+layout (location = 0) in vec2 position;
+layout (location = 1) in vec2 size;
+layout (location = 2) in vec4 uvRect;
+layout (location = 3) in vec4 color;
+layout (location = 4) in float angle;
+layout (location = 5) in vec2 pivot;
+
+out vec2 fragUV;
+out vec4 fragColor;
+
+uniform mat4 projection;
+
+// corners of the quad, in triangle strip order
+const vec2 units[4] = vec2[4](
+	vec2(0, 0),
+	vec2(0, 1),
+	vec2(1, 0),
+	vec2(1, 1)
+);
+
+void main()
+{
+	vec2 unit = units[gl_VertexID];
+
+	// angle in 1/65536 of a turn, pivot in 1/254 of the size
+	float theta = angle * (6.283185307 / 65536.0);
+	vec2 origin = pivot / 254.0 * size;
+	vec2 corner = unit * size - origin;
+	float c = cos(theta);
+	float s = sin(theta);
+	corner = vec2(corner.x * c + corner.y * s, corner.y * c - corner.x * s);
+
+	fragUV = mix(uvRect.xy, uvRect.zw, unit);
+	fragColor = color;
+	gl_Position = projection * vec4(position + origin + corner, 0, 1);
+}
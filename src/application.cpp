@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstdint>
 #include <stdexcept>
 
@@ -14,16 +15,34 @@ namespace
 {
 const unsigned ScreenWidth = 800;
 const unsigned ScreenHeight = 600;
+
+// longest frame simulated, the time lost after a stall isn't caught up
+const double MaxFrameTime = 0.25;
+
+// time spent fast-forwarding between two polls of the window events
+const double FastForwardSlice = 0.05;
 }
 
 Application::Application()
+	: Application(Settings())
+{
+}
+
+Application::Application(const Settings &settings)
 	: mEventQueue()
 	, mWindow()
 	, mTarget()
 	, mFonts()
 	, mTextures()
 	, mViewStack({ &mWindow, &mTarget, &mFonts, &mTextures, })
+	, mSimulationStep(1.0 / settings.simulationRate)
+	, mIdleWait(std::max(settings.idleWait, 0.0))
 {
+	if (!(settings.simulationRate > 0.0))
+	{
+		throw std::runtime_error("The simulation rate must be positive");
+	}
+
 	if (!glfwInit())
 	{
 		const char *error;
@@ -43,7 +62,7 @@ Application::Application()
 	// with a context in use we load the assets
 	loadAssets();
 
-	registerViews();
+	registerViews(settings);
 
 	// push the first view
 	mViewStack.pushView(ViewID::Title);
@@ -68,10 +87,10 @@ Application::loadAssets()
 }
 
 void
-Application::registerViews()
+Application::registerViews(const Settings &settings)
 {
 	mViewStack.registerView<TitleView>(ViewID::Title);
-	mViewStack.registerView<GameView>(ViewID::GamePlay);
+	mViewStack.registerView<GameView>(ViewID::GamePlay, settings.game);
 	mViewStack.registerView<GameOverView>(ViewID::GameOver);
 	mViewStack.registerView<PauseView>(ViewID::Paused);
 }
@@ -79,30 +98,76 @@ Application::registerViews()
 void
 Application::run()
 {
-	// variable-time game loop
+	// fixed-step game loop, the elapsed time is consumed in steps of
+	// mSimulationStep and the remainder interpolates the rendering
 	auto currentTime = glfwGetTime();
+	double accumulator = 0.0;
 	while (!mWindow.isClosed() && !mViewStack.empty())
 	{
 		auto newTime = glfwGetTime();
-		auto frameTime = newTime - currentTime;
+		accumulator += std::min(newTime - currentTime, MaxFrameTime);
 		currentTime = newTime;
 
-		processInput();
-		mViewStack.update(frameTime);
+		bool hasInput = processInput();
+		if (mViewStack.isFastForwarding())
+		{
+			fastForward();
+			currentTime = glfwGetTime();
+			accumulator = 0.0;
+			continue;
+		}
+
+		while (accumulator >= mSimulationStep)
+		{
+			mViewStack.update(mSimulationStep);
+			accumulator -= mSimulationStep;
+		}
+
+		// a frame showing nothing new isn't rendered nor swapped,
+		// the loop sleeps until an event, or the next update if the
+		// views run a timer
+		if (mIdleWait > 0.0 && !hasInput && !mViewStack.hasChanged())
+		{
+			if (mViewStack.needsUpdates())
+			{
+				mEventQueue.wait(std::min(mIdleWait, mSimulationStep - accumulator));
+			}
+			else
+			{
+				// the time slept isn't simulated
+				mEventQueue.wait(mIdleWait);
+				currentTime = glfwGetTime();
+			}
+			continue;
+		}
 
 		// render
-		mViewStack.render(mTarget);
+		mViewStack.render(mTarget, accumulator / mSimulationStep);
 		mWindow.display();
 	}
 }
 
 void
+Application::fastForward()
+{
+	// the steps keep their length so the game plays the same, the
+	// events are still polled to keep the window responsive
+	auto deadline = glfwGetTime() + FastForwardSlice;
+	while (mViewStack.isFastForwarding() && glfwGetTime() < deadline)
+	{
+		mViewStack.update(mSimulationStep);
+	}
+}
+
+bool
 Application::processInput()
 {
 	mEventQueue.poll();
+	bool hasInput = false;
 	Event event;
 	while (mEventQueue.pop(event))
 	{
+		hasInput = true;
 		if (mViewStack.handleEvent(event))
 		{
 			// event handled by a view in the stack
@@ -113,4 +178,5 @@ Application::processInput()
 			mWindow.close();
 		}
 	}
+	return hasInput;
 }
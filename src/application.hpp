@@ -6,21 +6,38 @@
 #include "resources.hpp"
 #include "resourceholder.hpp"
 #include "viewstack.hpp"
+#include "gameview.hpp"
 #include "font.hpp"
 #include "texture.hpp"
 
 class Application
 {
+public:
+	struct Settings
+	{
+		// updates of the views per second, it can be lower than
+		// the display rate
+		double simulationRate = 60.0;
+
+		// longest wait for the events when the views have nothing
+		// new to show and nothing to update, zero renders every
+		// frame
+		double idleWait = 1.0;
+		GameView::Settings game;
+	};
+
 public:
 	Application();
+	explicit Application(const Settings &settings);
 	~Application();
 
 	void run();
 
 private:
-	void processInput();
+	bool processInput();
 	void loadAssets();
-	void registerViews();
+	void registerViews(const Settings &settings);
+	void fastForward();
 
 private:
 	EventQueue    mEventQueue;
@@ -29,4 +46,6 @@ private:
 	FontHolder    mFonts;
 	TextureHolder mTextures;
 	ViewStack     mViewStack;
+	double        mSimulationStep;
+	double        mIdleWait;
 };
@@ -0,0 +1,438 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "pipe.hpp"
+
+/**
+ * Board representation with one bit-plane per connector direction.
+ *
+ * Cell (x, y) is stored in bit y * Width + x of each plane, so the
+ * neighbours of a cell are one bit (horizontal) or one row
+ * (vertical) away and the water can be propagated to the whole
+ * board at once with shifts and masks.
+ *
+ * The board also keeps a Zobrist hash of its bits up to date: every
+ * bit of every plane has its own random key and the hash is the xor
+ * of the keys of the bits set, so each change costs one xor.
+ */
+template <int Width, int Height>
+class BitBoard
+{
+public:
+	BitBoard();
+
+	void clear();
+
+	void setType(int x, int y, Pipe::Type type);
+	bool hasConnector(int x, int y, Pipe::Direction dir) const;
+
+	/**
+	 * Get the Pipe::Direction bits of the cell (x, y).
+	 */
+	unsigned getConnectors(int x, int y) const;
+
+	/**
+	 * Rotate the connectors of the cell (x, y) like
+	 * Pipe::rotate() does.
+	 */
+	void rotate(int x, int y, bool clockwise);
+
+	/**
+	 * Get the Pipe::Direction bits @connectors after a rotation.
+	 */
+	static constexpr unsigned rotateConnectors(unsigned connectors, bool clockwise);
+
+	bool isFilled(int x, int y) const;
+	void setFilled(int x, int y, bool filled);
+	void resetWater();
+
+	/**
+	 * Flood the pipes connected to the left edge of the row @y
+	 * and append the cells reached to @chain.
+	 *
+	 * The cells already filled are not visited again and the
+	 * cells reached are marked as filled. If the chain leaves the
+	 * board from the right edge the exit cell is the last one.
+	 *
+	 * The cells come in index order rather than along the path,
+	 * but the chain has the cells, and the last cell when it
+	 * scores, of the recursive Board::propagateWater(): every pipe
+	 * has two connectors, so the water follows a single path and a
+	 * cell of the last column with a Right connector can only be
+	 * its end.
+	 */
+	void getWaterChain(int y, std::vector<glm::ivec2> &chain);
+
+	std::uint64_t getHash() const;
+
+	bool operator==(const BitBoard &other) const = default;
+
+private:
+	static constexpr int CellCount = Width * Height;
+	static constexpr int WordBits = 64;
+	static constexpr int WordCount = (CellCount + WordBits - 1) / WordBits;
+
+	typedef std::array<std::uint64_t, WordCount> Plane;
+
+	static Plane shiftUp(const Plane &plane, int count);
+	static Plane shiftDown(const Plane &plane, int count);
+	static constexpr Plane makeColumnMask(int column);
+	static constexpr Plane makeBoardMask();
+
+	static constexpr bool testBit(const Plane &plane, int index);
+	static constexpr void setBit(Plane &plane, int index, bool value);
+	static constexpr int getPlaneIndex(Pipe::Direction dir);
+	static constexpr std::uint64_t makeKey(int plane, int index);
+	static std::uint64_t getKey(int plane, int index);
+
+	void assignBit(Plane &plane, int planeIndex, int index, bool value);
+
+	static const Plane LastColumn;
+	static const Plane BoardMask;
+	static constexpr int FilledPlane = 4;
+
+private:
+	Plane mConnectors[4];
+	Plane mFilled;
+	std::uint64_t mHash;
+};
+
+template <int Width, int Height>
+constexpr typename BitBoard<Width, Height>::Plane
+BitBoard<Width, Height>::LastColumn = makeColumnMask(Width - 1);
+
+template <int Width, int Height>
+constexpr typename BitBoard<Width, Height>::Plane
+BitBoard<Width, Height>::BoardMask = makeBoardMask();
+
+template <int Width, int Height>
+BitBoard<Width, Height>::BitBoard()
+	: mConnectors()
+	, mFilled()
+	, mHash(0)
+{
+}
+
+template <int Width, int Height>
+void
+BitBoard<Width, Height>::clear()
+{
+	for (auto &plane: mConnectors)
+	{
+		plane.fill(0);
+	}
+	mFilled.fill(0);
+	mHash = 0;
+}
+
+template <int Width, int Height>
+void
+BitBoard<Width, Height>::setType(int x, int y, Pipe::Type type)
+{
+	assert(0 <= y && y < Height && 0 <= x && x < Width
+	       && "Coordinates out of the board");
+
+	auto connectors = Pipe::getConnectors(type);
+	for (int i = 0; i < 4; i++)
+	{
+		assignBit(mConnectors[i], i, y * Width + x, connectors & (1 << i));
+	}
+}
+
+template <int Width, int Height>
+bool
+BitBoard<Width, Height>::hasConnector(int x, int y, Pipe::Direction dir) const
+{
+	return testBit(mConnectors[getPlaneIndex(dir)], y * Width + x);
+}
+
+template <int Width, int Height>
+unsigned
+BitBoard<Width, Height>::getConnectors(int x, int y) const
+{
+	unsigned connectors = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		connectors |= testBit(mConnectors[i], y * Width + x) << i;
+	}
+	return connectors;
+}
+
+template <int Width, int Height>
+void
+BitBoard<Width, Height>::rotate(int x, int y, bool clockwise)
+{
+	auto connectors = rotateConnectors(getConnectors(x, y), clockwise);
+	for (int i = 0; i < 4; i++)
+	{
+		assignBit(mConnectors[i], i, y * Width + x, connectors & (1 << i));
+	}
+}
+
+template <int Width, int Height>
+constexpr unsigned
+BitBoard<Width, Height>::rotateConnectors(unsigned connectors, bool clockwise)
+{
+	// the direction bits go counterclockwise from Top, so a
+	// clockwise rotation moves every bit one place down
+	connectors = clockwise
+		? (connectors >> 1) | (connectors << 3)
+		: (connectors << 1) | (connectors >> 3);
+	return connectors & 0xF;
+}
+
+template <int Width, int Height>
+bool
+BitBoard<Width, Height>::isFilled(int x, int y) const
+{
+	return testBit(mFilled, y * Width + x);
+}
+
+template <int Width, int Height>
+void
+BitBoard<Width, Height>::setFilled(int x, int y, bool filled)
+{
+	assignBit(mFilled, FilledPlane, y * Width + x, filled);
+}
+
+template <int Width, int Height>
+void
+BitBoard<Width, Height>::resetWater()
+{
+	for (int i = 0; i < WordCount; i++)
+	{
+		for (auto bits = mFilled[i]; bits; bits &= bits - 1)
+		{
+			mHash ^= getKey(FilledPlane, i * WordBits + std::countr_zero(bits));
+		}
+	}
+	mFilled.fill(0);
+}
+
+template <int Width, int Height>
+std::uint64_t
+BitBoard<Width, Height>::getHash() const
+{
+	return mHash;
+}
+
+template <int Width, int Height>
+void
+BitBoard<Width, Height>::getWaterChain(int y, std::vector<glm::ivec2> &chain)
+{
+	static_assert([] {
+		for (int type = 0; type < Pipe::Empty; type++)
+		{
+			auto connectors = Pipe::getConnectors(static_cast<Pipe::Type>(type));
+			if (std::popcount(connectors) != 2)
+			{
+				return false;
+			}
+		}
+		return true;
+	}(), "The exit cell is only known to end the chain for two-way pipes");
+
+	int start = y * Width;
+	if (!testBit(mConnectors[getPlaneIndex(Pipe::Left)], start)
+	    || testBit(mFilled, start))
+	{
+		return;
+	}
+
+	// bit i of horizontal is set when the cell i is connected
+	// to the cell i+1, bit i of vertical when it is connected
+	// to the cell i+Width.
+	const auto &top = mConnectors[getPlaneIndex(Pipe::Top)];
+	const auto &left = mConnectors[getPlaneIndex(Pipe::Left)];
+	const auto &bottom = mConnectors[getPlaneIndex(Pipe::Bottom)];
+	const auto &right = mConnectors[getPlaneIndex(Pipe::Right)];
+	auto leftOfNext = shiftDown(left, 1);
+	auto topOfNext = shiftDown(top, Width);
+	Plane horizontal, vertical, open;
+	for (int i = 0; i < WordCount; i++)
+	{
+		horizontal[i] = right[i] & leftOfNext[i] & ~LastColumn[i];
+		vertical[i] = bottom[i] & topOfNext[i];
+		open[i] = BoardMask[i] & ~mFilled[i];
+	}
+
+	Plane water{};
+	setBit(water, start, true);
+	for (bool changed = true; changed;)
+	{
+		auto toRight = shiftUp(water, 1);
+		auto fromRight = shiftDown(water, 1);
+		auto toBottom = shiftUp(water, Width);
+		auto fromBottom = shiftDown(water, Width);
+		auto shiftedHorizontal = shiftUp(horizontal, 1);
+		auto shiftedVertical = shiftUp(vertical, Width);
+
+		changed = false;
+		for (int i = 0; i < WordCount; i++)
+		{
+			auto next = water[i]
+				| (toRight[i] & shiftedHorizontal[i])
+				| (fromRight[i] & horizontal[i])
+				| (toBottom[i] & shiftedVertical[i])
+				| (fromBottom[i] & vertical[i]);
+			next &= open[i];
+			changed |= next != water[i];
+			water[i] = next;
+		}
+	}
+
+	int exitIndex = -1;
+	for (int i = 0; i < WordCount; i++)
+	{
+		mFilled[i] |= water[i];
+		for (auto bits = water[i]; bits; bits &= bits - 1)
+		{
+			int index = i * WordBits + std::countr_zero(bits);
+			mHash ^= getKey(FilledPlane, index);
+			if (testBit(LastColumn, index) && testBit(right, index))
+			{
+				exitIndex = index;
+				continue;
+			}
+			chain.emplace_back(index % Width, index / Width);
+		}
+	}
+	if (exitIndex >= 0)
+	{
+		chain.emplace_back(exitIndex % Width, exitIndex / Width);
+	}
+}
+
+template <int Width, int Height>
+typename BitBoard<Width, Height>::Plane
+BitBoard<Width, Height>::shiftUp(const Plane &plane, int count)
+{
+	Plane result{};
+	int words = count / WordBits;
+	int bits = count % WordBits;
+	for (int i = WordCount - 1; i >= words; i--)
+	{
+		result[i] = plane[i - words] << bits;
+		if (bits && i - words - 1 >= 0)
+		{
+			result[i] |= plane[i - words - 1] >> (WordBits - bits);
+		}
+	}
+	return result;
+}
+
+template <int Width, int Height>
+typename BitBoard<Width, Height>::Plane
+BitBoard<Width, Height>::shiftDown(const Plane &plane, int count)
+{
+	Plane result{};
+	int words = count / WordBits;
+	int bits = count % WordBits;
+	for (int i = 0; i + words < WordCount; i++)
+	{
+		result[i] = plane[i + words] >> bits;
+		if (bits && i + words + 1 < WordCount)
+		{
+			result[i] |= plane[i + words + 1] << (WordBits - bits);
+		}
+	}
+	return result;
+}
+
+template <int Width, int Height>
+constexpr typename BitBoard<Width, Height>::Plane
+BitBoard<Width, Height>::makeColumnMask(int column)
+{
+	Plane mask{};
+	for (int y = 0; y < Height; y++)
+	{
+		setBit(mask, y * Width + column, true);
+	}
+	return mask;
+}
+
+template <int Width, int Height>
+constexpr typename BitBoard<Width, Height>::Plane
+BitBoard<Width, Height>::makeBoardMask()
+{
+	Plane mask{};
+	for (int i = 0; i < CellCount; i++)
+	{
+		setBit(mask, i, true);
+	}
+	return mask;
+}
+
+template <int Width, int Height>
+constexpr bool
+BitBoard<Width, Height>::testBit(const Plane &plane, int index)
+{
+	return (plane[index / WordBits] >> (index % WordBits)) & 1;
+}
+
+template <int Width, int Height>
+constexpr void
+BitBoard<Width, Height>::setBit(Plane &plane, int index, bool value)
+{
+	auto bit = std::uint64_t(1) << (index % WordBits);
+	if (value)
+	{
+		plane[index / WordBits] |= bit;
+	}
+	else
+	{
+		plane[index / WordBits] &= ~bit;
+	}
+}
+
+template <int Width, int Height>
+constexpr int
+BitBoard<Width, Height>::getPlaneIndex(Pipe::Direction dir)
+{
+	return std::countr_zero(static_cast<unsigned>(dir));
+}
+
+template <int Width, int Height>
+std::uint64_t
+BitBoard<Width, Height>::getKey(int plane, int index)
+{
+	static const auto keys = []() {
+		std::vector<std::uint64_t> keys((FilledPlane + 1) * CellCount);
+		for (int i = 0; i < static_cast<int>(keys.size()); i++)
+		{
+			keys[i] = makeKey(i / CellCount, i % CellCount);
+		}
+		return keys;
+	}();
+	return keys[plane * CellCount + index];
+}
+
+template <int Width, int Height>
+constexpr std::uint64_t
+BitBoard<Width, Height>::makeKey(int plane, int index)
+{
+	// splitmix64 of the position of the bit
+	std::uint64_t z = (static_cast<std::uint64_t>(plane) * CellCount + index + 1)
+		* 0x9e3779b97f4a7c15ULL;
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+template <int Width, int Height>
+void
+BitBoard<Width, Height>::assignBit(Plane &plane, int planeIndex, int index, bool value)
+{
+	if (testBit(plane, index) != value)
+	{
+		setBit(plane, index, value);
+		mHash ^= getKey(planeIndex, index);
+	}
+}
@@ -1,24 +1,49 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <iterator>
+#include <type_traits>
 #include <vector>
-#include <map>
-#include <memory>
+#include <span>
 
 #include <glm/glm.hpp>
 
+#include "bitboard.hpp"
 #include "pipe.hpp"
-#include "rotatingpipe.hpp"
-#include "fallingpipe.hpp"
-#include "fadingpipe.hpp"
+#include "pipeanimations.hpp"
+#include "random.hpp"
 
-class Board
+/**
+ * Game board of Width x Height pipes.
+ *
+ * All the sizes and the index math are known at compile time, the
+ * classic game uses the Board typedef. The larger boards are big
+ * enough that they should be allocated on the heap.
+ */
+template <int Width, int Height>
+class BasicBoard
 {
 public:
-	static const int BoardWidth = 8;
-	static const int BoardHeight = 10;
+	static const int BoardWidth = Width;
+	static const int BoardHeight = Height;
+
+	/**
+	 * State of a board in a fixed-size blob that can be copied
+	 * with memcpy: the pipes, the generator of the new pipes and
+	 * the animations in flight. The water chains are traced again
+	 * from the pipes after a restore.
+	 */
+	struct Snapshot
+	{
+		Pipe pipes[Width * Height];
+		Random::State random;
+		PipeAnimations<Width, Height> animations;
+	};
 
 public:
-	Board();
+	explicit BasicBoard(std::uint64_t seed = 0);
 
 	void clear();
 
@@ -34,31 +59,659 @@ public:
 	void makeNewPipes(bool dropPipes);
 	void resetWater();
 	void fillPipe(int x, int y);
+	void setFilled(int x, int y, bool filled);
 
 	void propagateWater(int x, int y, Pipe::Direction from);
 	const std::vector<glm::ivec2>& getWaterChain(int y);
 
+	/**
+	 * Bring the water chains of every row up to date, filling the
+	 * pipes connected to the left edge.
+	 *
+	 * Only the chains touching the cells changed since the last
+	 * call are traced again, the others are kept as they are. The
+	 * chains are then available with getComputedChain() and have
+	 * the same content as calling getWaterChain() for every row in
+	 * order after resetWater().
+	 */
+	void computeWaterChains();
+	std::span<const glm::ivec2> getComputedChain(int y) const;
+	bool reachesRightEdge(int y) const;
+
 	bool arePipesAnimating() const;
-	void updateAnimatedPipes();
+	void updateAnimatedPipes(float dt);
 
 	void addFallingPipe(int x, int y, Pipe::Type type, int verticalOffset);
 	void addRotatingPipe(int x, int y, Pipe::Type type, bool clockwise);
 	void addFadingPipe(int x, int y, Pipe::Type type);
+	const PipeAnimations<Width, Height>& getAnimations() const;
 
 	const Pipe& getPipe(int x, int y) const;
-	Pipe& getPipe(int x, int y);
+	const BitBoard<Width, Height>& getBitBoard() const;
+
+	/**
+	 * Zobrist hash of the pipes and of the water, kept up to date
+	 * by every change of the board.
+	 */
+	std::uint64_t getHash() const;
+
+	Random& getRandom();
+	const Random& getRandom() const;
+
+	void saveSnapshot(Snapshot &snapshot) const;
+	void restoreSnapshot(const Snapshot &snapshot);
 
 private:
-	void updateFallingPipes();
-	void updateRotatingPipes();
-	void updateFadingPipes();
+	static constexpr int CellCount = Width * Height;
+
+	struct Neighbour
+	{
+		int dx;
+		int dy;
+		Pipe::Direction entry;
+	};
+
+	// indexed by the bit of the direction leaving the cell
+	static constexpr Neighbour Neighbours[] = {
+		{  0, -1, Pipe::Bottom },
+		{ -1,  0, Pipe::Right },
+		{  0,  1, Pipe::Top },
+		{  1,  0, Pipe::Left },
+	};
+
+	static constexpr int getIndex(int x, int y);
+	static constexpr bool isInside(int x, int y);
+
+	Pipe& pipeAt(int x, int y);
+	void storeType(int x, int y, Pipe::Type type);
+	void storeFilled(int x, int y, bool filled);
+	void compactColumns();
+	void markDirty(int x, int y);
+	void invalidateWater();
+	void traceChain(int row);
 
 private:
-	Pipe mPipes[BoardWidth * BoardHeight];
+	Pipe mPipes[CellCount];
+	BitBoard<BoardWidth, BoardHeight> mBitBoard;
 	std::vector<glm::ivec2> mWaterTracker;
 
-public:
-	std::map<std::pair<int, int>, std::unique_ptr<FallingPipe>> mFallingPipes;
-	std::map<std::pair<int, int>, std::unique_ptr<RotatingPipe>> mRotatingPipes;
-	std::map<std::pair<int, int>, std::unique_ptr<FadingPipe>> mFadingPipes;
+	std::vector<glm::ivec2> mChains[BoardHeight];
+	bool mChainExits[BoardHeight];
+	int mChainRows[CellCount];
+
+	bool mDirty[CellCount];
+	int mDirtyCells[CellCount];
+	int mDirtyCount;
+	bool mWaterValid;
+	int mEmptyCount;
+
+	Random mRandom;
+	std::uint8_t mNewTypes[CellCount];
+
+	PipeAnimations<Width, Height> mAnimations;
 };
+
+typedef BasicBoard<8, 10> Board;
+extern template class BasicBoard<8, 10>;
+
+template <int Width, int Height>
+BasicBoard<Width, Height>::BasicBoard(std::uint64_t seed)
+	: mPipes()
+	, mBitBoard()
+	, mChains()
+	, mChainExits()
+	, mChainRows()
+	, mDirty()
+	, mDirtyCells()
+	, mDirtyCount(0)
+	, mWaterValid(false)
+	, mEmptyCount(CellCount)
+	, mRandom(seed)
+	, mNewTypes()
+	, mAnimations()
+{
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::clear()
+{
+	for (auto &pipe: mPipes)
+	{
+		pipe.setType(Pipe::Empty);
+		pipe.setFilled(false);
+	}
+	mBitBoard.clear();
+	mEmptyCount = CellCount;
+	invalidateWater();
+}
+
+template <int Width, int Height>
+constexpr int
+BasicBoard<Width, Height>::getIndex(int x, int y)
+{
+	return y * Width + x;
+}
+
+template <int Width, int Height>
+constexpr bool
+BasicBoard<Width, Height>::isInside(int x, int y)
+{
+	return 0 <= y && y < Height && 0 <= x && x < Width;
+}
+
+template <int Width, int Height>
+const Pipe&
+BasicBoard<Width, Height>::getPipe(int x, int y) const
+{
+	assert(isInside(x, y) && "Coordinates out of the board");
+
+	return mPipes[getIndex(x, y)];
+}
+
+template <int Width, int Height>
+const BitBoard<Width, Height>&
+BasicBoard<Width, Height>::getBitBoard() const
+{
+	return mBitBoard;
+}
+
+template <int Width, int Height>
+std::uint64_t
+BasicBoard<Width, Height>::getHash() const
+{
+	return mBitBoard.getHash();
+}
+
+template <int Width, int Height>
+Random&
+BasicBoard<Width, Height>::getRandom()
+{
+	return mRandom;
+}
+
+template <int Width, int Height>
+const Random&
+BasicBoard<Width, Height>::getRandom() const
+{
+	return mRandom;
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::saveSnapshot(Snapshot &snapshot) const
+{
+	static_assert(std::is_trivially_copyable_v<Snapshot>,
+	              "A snapshot must be a plain blob");
+
+	std::copy(std::begin(mPipes), std::end(mPipes), snapshot.pipes);
+	snapshot.random = mRandom.getState();
+	snapshot.animations = mAnimations;
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::restoreSnapshot(const Snapshot &snapshot)
+{
+	for (int i = 0; i < CellCount; i++)
+	{
+		const auto &pipe = snapshot.pipes[i];
+		storeType(i % Width, i / Width, pipe.getType());
+		storeFilled(i % Width, i / Width, pipe.isFilled());
+	}
+	mRandom.setState(snapshot.random);
+	mAnimations = snapshot.animations;
+	invalidateWater();
+}
+
+template <int Width, int Height>
+Pipe &
+BasicBoard<Width, Height>::pipeAt(int x, int y)
+{
+	return const_cast<Pipe&>(static_cast<const BasicBoard *>(this)->getPipe(x, y));
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::rotatePipe(int x, int y, bool clockwise)
+{
+	auto pipe = getPipe(x, y);
+	pipe.rotate(clockwise);
+	storeType(x, y, pipe.getType());
+}
+
+template <int Width, int Height>
+FloatRect
+BasicBoard<Width, Height>::getSourceRect(int x, int y) const
+{
+	return getPipe(x, y).getSourceRect();
+}
+
+template <int Width, int Height>
+bool
+BasicBoard<Width, Height>::hasConnector(int x, int y, Pipe::Direction dir) const
+{
+	return getPipe(x, y).hasConnector(dir);
+}
+
+template <int Width, int Height>
+Pipe::Type
+BasicBoard<Width, Height>::getType(int x, int y) const
+{
+	return getPipe(x, y).getType();
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::setType(int x, int y, Pipe::Type type)
+{
+	storeType(x, y, type);
+	storeFilled(x, y, false);
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::randomizePipe(int x, int y)
+{
+	storeType(x, y, static_cast<Pipe::Type>(
+		          mRandom.nextInt(Pipe::BottomLeft + 1)));
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::storeType(int x, int y, Pipe::Type type)
+{
+	auto &pipe = pipeAt(x, y);
+	mEmptyCount += (type == Pipe::Empty) - (pipe.getType() == Pipe::Empty);
+	pipe.setType(type);
+	mBitBoard.setType(x, y, type);
+	markDirty(x, y);
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::fillFromAbove(int x, int y)
+{
+	assert(isInside(x, y) && "Coordinates out of the board");
+
+	int rowLookup = y - 1;
+	while (rowLookup >= 0)
+	{
+		auto type = getType(x, rowLookup);
+		if (type != Pipe::Empty)
+		{
+			setType(x, y, type);
+			setType(x, rowLookup, Pipe::Empty);
+			addFallingPipe(x, y, getType(x, y), Pipe::PipeHeight * ( y - rowLookup));
+			rowLookup = -1;
+		}
+		rowLookup--;
+	}
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::compactColumns()
+{
+	// one sweep from the bottom row with a write row per column:
+	// every pipe falls straight to its final place, the same that
+	// calling fillFromAbove() on the empty cells would give
+	int writeRows[Width];
+	for (auto &row: writeRows)
+	{
+		row = Height - 1;
+	}
+
+	for (int y = Height - 1; y >= 0; y--)
+	{
+		for (int x = 0; x < Width; x++)
+		{
+			auto type = mPipes[getIndex(x, y)].getType();
+			if (type == Pipe::Empty)
+			{
+				continue;
+			}
+
+			int row = writeRows[x]--;
+			if (row != y)
+			{
+				storeType(x, row, type);
+				storeType(x, y, Pipe::Empty);
+				addFallingPipe(x, row, type, Pipe::PipeHeight * (row - y));
+			}
+		}
+	}
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::makeNewPipes(bool dropPipes)
+{
+	if (mEmptyCount == 0)
+	{
+		return;
+	}
+	if (dropPipes)
+	{
+		compactColumns();
+	}
+
+	// draw all the new pipes at once, in board order
+	int count = mEmptyCount;
+	mRandom.fill(std::span(mNewTypes, count), Pipe::BottomLeft + 1);
+	for (int y = 0, i = 0; y < BoardHeight && i < count; y++)
+	{
+		for (int x = 0; x < BoardWidth && i < count; x++)
+		{
+			if (getType(x, y) == Pipe::Empty)
+			{
+				storeType(x, y, static_cast<Pipe::Type>(mNewTypes[i++]));
+				addFallingPipe(x, y, getType(x, y), Pipe::PipeHeight * BoardHeight);
+			}
+		}
+	}
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::resetWater()
+{
+	for (auto &pipe: mPipes)
+	{
+		pipe.setFilled(false);
+	}
+	mBitBoard.resetWater();
+	invalidateWater();
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::fillPipe(int x, int y)
+{
+	setFilled(x, y, true);
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::setFilled(int x, int y, bool filled)
+{
+	storeFilled(x, y, filled);
+	invalidateWater();
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::storeFilled(int x, int y, bool filled)
+{
+	pipeAt(x, y).setFilled(filled);
+	mBitBoard.setFilled(x, y, filled);
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::markDirty(int x, int y)
+{
+	int cell = getIndex(x, y);
+	if (!mDirty[cell])
+	{
+		mDirty[cell] = true;
+		mDirtyCells[mDirtyCount++] = cell;
+	}
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::invalidateWater()
+{
+	mWaterValid = false;
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::propagateWater(int x, int y, Pipe::Direction from)
+{
+	if (isInside(x, y))
+	{
+		const auto &pipe = getPipe(x, y);
+		if (pipe.hasConnector(from) && !pipe.isFilled())
+		{
+			setFilled(x, y, true);
+			mWaterTracker.emplace_back(x, y);
+			for (int i = 0; i < 4; i++)
+			{
+				auto dst = static_cast<Pipe::Direction>(1<<i);
+				if (dst == from || !pipe.hasConnector(dst))
+				{
+					continue;
+				}
+				switch (dst)
+				{
+				case Pipe::Left:
+					propagateWater(x-1, y, Pipe::Right);
+					break;
+				case Pipe::Right:
+					propagateWater(x+1, y, Pipe::Left);
+					break;
+				case Pipe::Top:
+					propagateWater(x, y-1, Pipe::Bottom);
+					break;
+				case Pipe::Bottom:
+					propagateWater(x, y+1, Pipe::Top);
+					break;
+				}
+			}
+		}
+	}
+}
+
+template <int Width, int Height>
+const std::vector<glm::ivec2>&
+BasicBoard<Width, Height>::getWaterChain(int y)
+{
+	mWaterTracker.clear();
+	mBitBoard.getWaterChain(y, mWaterTracker);
+	for (auto pos: mWaterTracker)
+	{
+		pipeAt(pos.x, pos.y).setFilled(true);
+	}
+	invalidateWater();
+
+	return mWaterTracker;
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::computeWaterChains()
+{
+	bool affected[BoardHeight] = {};
+	if (!mWaterValid)
+	{
+		// start from scratch
+		for (int i = 0; i < CellCount; i++)
+		{
+			mChainRows[i] = -1;
+			storeFilled(i % BoardWidth, i / BoardWidth, false);
+		}
+		for (int y = 0; y < BoardHeight; y++)
+		{
+			mChains[y].clear();
+			affected[y] = true;
+		}
+	}
+	else if (mDirtyCount == 0)
+	{
+		return;
+	}
+	else
+	{
+		// a chain can change only if it crosses a dirty cell or
+		// ends next to one
+		for (int i = 0; i < mDirtyCount; i++)
+		{
+			int x = mDirtyCells[i] % BoardWidth;
+			int y = mDirtyCells[i] / BoardWidth;
+			if (int row = mChainRows[mDirtyCells[i]]; row >= 0)
+			{
+				affected[row] = true;
+			}
+			for (const auto &n: Neighbours)
+			{
+				if (isInside(x + n.dx, y + n.dy))
+				{
+					int row = mChainRows[getIndex(x + n.dx, y + n.dy)];
+					if (row >= 0)
+					{
+						affected[row] = true;
+					}
+				}
+			}
+			if (x == 0)
+			{
+				affected[y] = true;
+			}
+		}
+
+		// the rows starting on a released chain must be traced
+		// again and the cells released
+		bool released[BoardHeight] = {};
+		for (int y = 0; y < BoardHeight; y++)
+		{
+			if (!affected[y])
+			{
+				continue;
+			}
+			for (auto pos: mChains[y])
+			{
+				if (pos.x == 0)
+				{
+					released[pos.y] = true;
+				}
+				mChainRows[getIndex(pos.x, pos.y)] = -1;
+				storeFilled(pos.x, pos.y, false);
+			}
+			mChains[y].clear();
+		}
+		for (int y = 0; y < BoardHeight; y++)
+		{
+			affected[y] = affected[y] || released[y];
+		}
+	}
+
+	for (int y = 0; y < BoardHeight; y++)
+	{
+		if (affected[y])
+		{
+			traceChain(y);
+		}
+	}
+
+	for (int i = 0; i < mDirtyCount; i++)
+	{
+		mDirty[mDirtyCells[i]] = false;
+	}
+	mDirtyCount = 0;
+	mWaterValid = true;
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::traceChain(int row)
+{
+	auto &chain = mChains[row];
+	chain.clear();
+
+	// every pipe has two connectors, the water leaves from the
+	// one it didn't enter
+	int x = 0;
+	int y = row;
+	unsigned from = Pipe::Left;
+	while (isInside(x, y))
+	{
+		int cell = getIndex(x, y);
+		auto connectors = Pipe::getConnectors(mPipes[cell].getType());
+		if (!(connectors & from) || mChainRows[cell] >= 0)
+		{
+			break;
+		}
+
+		mChainRows[cell] = row;
+		storeFilled(x, y, true);
+		chain.emplace_back(x, y);
+
+		const auto &n = Neighbours[std::countr_zero(connectors & ~from)];
+		x += n.dx;
+		y += n.dy;
+		from = n.entry;
+	}
+	mChainExits[row] = x == BoardWidth;
+}
+
+template <int Width, int Height>
+std::span<const glm::ivec2>
+BasicBoard<Width, Height>::getComputedChain(int y) const
+{
+	assert(0 <= y && y < BoardHeight && "Row out of the board");
+
+	return mChains[y];
+}
+
+template <int Width, int Height>
+bool
+BasicBoard<Width, Height>::reachesRightEdge(int y) const
+{
+	assert(0 <= y && y < BoardHeight && "Row out of the board");
+
+	return mChainExits[y];
+}
+
+template <int Width, int Height>
+bool
+BasicBoard<Width, Height>::arePipesAnimating() const
+{
+	return mAnimations.isAnimating();
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::updateAnimatedPipes(float dt)
+{
+	// the pipes fall and rotate once the scored chains are gone
+	using Animations = PipeAnimations<Width, Height>;
+	if (mAnimations.isAnimating(Animations::Fading))
+	{
+		mAnimations.update(Animations::Fading, dt);
+	}
+	else
+	{
+		mAnimations.update(Animations::Falling | Animations::Rotating, dt);
+	}
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::addFallingPipe(int x, int y, Pipe::Type type, int verticalOffset)
+{
+	mAnimations.addFalling(x, y, type, verticalOffset);
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::addRotatingPipe(int x, int y, Pipe::Type type, bool clockwise)
+{
+	mAnimations.addRotating(x, y, type, clockwise);
+}
+
+template <int Width, int Height>
+void
+BasicBoard<Width, Height>::addFadingPipe(int x, int y, Pipe::Type type)
+{
+	mAnimations.addFading(x, y, type);
+}
+
+template <int Width, int Height>
+const PipeAnimations<Width, Height>&
+BasicBoard<Width, Height>::getAnimations() const
+{
+	return mAnimations;
+}
+
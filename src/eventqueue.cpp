@@ -42,6 +42,12 @@ EventQueue::poll()
 	glfwPollEvents();
 }
 
+void
+EventQueue::wait(double timeout)
+{
+	glfwWaitEventsTimeout(timeout);
+}
+
 bool
 EventQueue::empty() const
 {
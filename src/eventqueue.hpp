@@ -15,6 +15,11 @@ public:
 	~EventQueue();
 
 	void poll();
+
+	/**
+	 * Wait up to @timeout seconds for an event.
+	 */
+	void wait(double timeout);
 	bool empty() const;
 	bool pop(Event &event);
 
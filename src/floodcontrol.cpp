@@ -1,18 +1,98 @@
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
 
 #include "application.hpp"
 
-int main(int argc, char **argv)
+namespace
+{
+
+void
+usage(const char *name)
+{
+	std::cout << "Usage: " << name << " [options]\n"
+		  << "  --sim-rate HZ            updates of the game per second\n"
+		  << "  --idle-wait SECONDS      longest wait for events when nothing\n"
+		  << "                           changed on screen and no timer runs,\n"
+		  << "                           0 renders every frame\n"
+		  << "  --record FILE            write the replay of each game to FILE\n"
+		  << "  --replay FILE            play the replay FILE back, the player\n"
+		  << "                           takes over at its end\n"
+		  << "  --turbo-ticks TICKS      fast-forward the first TICKS updates\n"
+		  << "  --turbo-level LEVEL      fast-forward until LEVEL is reached\n"
+		  << "  --turbo-policy idle|random|greedy|beam\n"
+		  << "                           policy playing the fast-forward\n";
+}
+
+Application::Settings
+parseSettings(int argc, char **argv)
 {
-	if(argc != 1)
+	Application::Settings settings;
+	for (int i = 1; i < argc; i++)
 	{
-		std::cout << argv[0] <<  "takes no arguments.\n";
-		return 1;
+		std::string arg = argv[i];
+		if (arg == "-h" || arg == "--help")
+		{
+			usage(argv[0]);
+			std::exit(0);
+		}
+		if (i + 1 >= argc)
+		{
+			throw std::runtime_error("Missing value for " + arg);
+		}
+
+		std::string value = argv[++i];
+		if (arg == "--sim-rate")
+		{
+			settings.simulationRate = std::stod(value);
+		}
+		else if (arg == "--idle-wait")
+		{
+			settings.idleWait = std::stod(value);
+		}
+		else if (arg == "--record")
+		{
+			settings.game.recordPath = value;
+		}
+		else if (arg == "--replay")
+		{
+			settings.game.replay = std::make_shared<Replay>(Replay::load(value));
+		}
+		else if (arg == "--turbo-ticks")
+		{
+			settings.game.fastForward.ticks = std::stol(value);
+		}
+		else if (arg == "--turbo-level")
+		{
+			settings.game.fastForward.level = std::stoi(value);
+		}
+		else if (arg == "--turbo-policy")
+		{
+			settings.game.fastForward.policy = value;
+		}
+		else
+		{
+			throw std::runtime_error("Unknown option " + arg);
+		}
 	}
 
+	// the replay is played on the steps it has been recorded with
+	if (settings.game.replay)
+	{
+		settings.simulationRate = 1.0 / settings.game.replay->getStep();
+	}
+	return settings;
+}
+
+}
+
+int main(int argc, char **argv)
+{
 	try
 	{
-		Application app;
+		Application app(parseSettings(argc, argv));
 		app.run();
 		return 0;
 	}
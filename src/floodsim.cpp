@@ -0,0 +1,402 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gamestate.hpp"
+#include "policy.hpp"
+#include "replay.hpp"
+#include "workstealingpool.hpp"
+
+namespace
+{
+
+static const float TickTime = 1.f / 60.f;
+
+struct Options
+{
+	int games = 1000;
+	unsigned threads = std::thread::hardware_concurrency();
+	std::string policy = "greedy";
+	std::uint64_t seed = 1;
+	long maxTicks = 60L * 60 * 30;
+	GameState::Rules rules;
+	std::vector<std::string> replays;
+	bool verify = false;
+};
+
+struct GameResult
+{
+	int score;
+	int level;
+	long ticks;
+
+	// differences at the first step that didn't match, if any
+	std::string divergence;
+};
+
+void
+usage(const char *name)
+{
+	std::cout << "Usage: " << name << " [options]\n"
+		  << "  -n GAMES                 number of games to play\n"
+		  << "  -j THREADS               number of worker threads\n"
+		  << "  -p idle|random|greedy|beam\n"
+		  << "                           policy playing the games\n"
+		  << "  -s SEED                  seed of the first game\n"
+		  << "  --max-ticks TICKS        stop a game after TICKS ticks\n"
+		  << "  --max-flood VALUE        MaxFloodCounter\n"
+		  << "  --initial-flood VALUE    flood increase of the first level\n"
+		  << "  --flood-acceleration VALUE\n"
+		  << "                           FloodAccelerationPerLevel\n"
+		  << "  --lines-per-level LINES  lines to complete a level\n"
+		  << "  --level-rotations K      rotations to score on a new level board,\n"
+		  << "                           0 for random boards; the boards are\n"
+		  << "                           searched when the levels start, tens\n"
+		  << "                           of ms per level\n"
+		  << "  --replay FILE            play the replay FILE back instead of\n"
+		  << "                           playing games, can be repeated\n"
+		  << "  --verify                 play every game again from its recorded\n"
+		  << "                           commands and compare the checksums\n";
+}
+
+Options
+parseOptions(int argc, char **argv)
+{
+	Options options;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "-h" || arg == "--help")
+		{
+			usage(argv[0]);
+			std::exit(0);
+		}
+		if (arg == "--verify")
+		{
+			options.verify = true;
+			continue;
+		}
+		if (i + 1 >= argc)
+		{
+			throw std::runtime_error("Missing value for " + arg);
+		}
+
+		std::string value = argv[++i];
+		if (arg == "-n")
+		{
+			options.games = std::stoi(value);
+		}
+		else if (arg == "-j")
+		{
+			options.threads = std::stoul(value);
+		}
+		else if (arg == "-p")
+		{
+			options.policy = value;
+		}
+		else if (arg == "-s")
+		{
+			options.seed = std::stoull(value);
+		}
+		else if (arg == "--max-ticks")
+		{
+			options.maxTicks = std::stol(value);
+		}
+		else if (arg == "--max-flood")
+		{
+			options.rules.maxFloodCounter = std::stof(value);
+		}
+		else if (arg == "--initial-flood")
+		{
+			options.rules.initialFloodIncrease = std::stof(value);
+		}
+		else if (arg == "--flood-acceleration")
+		{
+			options.rules.floodAccelerationPerLevel = std::stof(value);
+		}
+		else if (arg == "--lines-per-level")
+		{
+			options.rules.linesPerLevel = std::stoi(value);
+		}
+		else if (arg == "--level-rotations")
+		{
+			options.rules.levelRotations = std::stoi(value);
+		}
+		else if (arg == "--replay")
+		{
+			options.replays.push_back(value);
+		}
+		else
+		{
+			throw std::runtime_error("Unknown option " + arg);
+		}
+	}
+	return options;
+}
+
+std::string
+describeDivergence(const Replay::Divergence &divergence)
+{
+	std::ostringstream out;
+	out << "diverged at tick " << divergence.tick << ", changes of the step:\n";
+	GameState::printDifferences(out, divergence.previous, divergence.state);
+	return out.str();
+}
+
+/**
+ * Let the @policy play a step of the game.
+ *
+ * @retval true the @command was applied.
+ */
+bool
+playStep(GameState &state, Policy &policy, GameState::Command &command)
+{
+	bool hasCommand = state.acceptsInput() && policy.getCommand(state, command);
+	return state.update(TickTime, hasCommand ? &command : nullptr);
+}
+
+/**
+ * Describe the @divergence of the instance verifying the @game,
+ * compared to the game played by the policy.
+ *
+ * The policy plays the game again, on the recorded level boards, up
+ * to the diverging step. If it doesn't reach the recorded checksum
+ * either, the original game isn't deterministic itself.
+ */
+std::string
+describeDivergence(const Options &options, int game, const Replay &recording,
+                   const Replay::Divergence &divergence)
+{
+	std::uint64_t seed = options.seed + game;
+	GameState state(seed, options.rules);
+	state.setLevelSeeds(recording.getLevelSeeds());
+	auto policy = Policy::create(options.policy, ~seed);
+	GameState::Command command;
+	for (long tick = 0; tick < divergence.tick; tick++)
+	{
+		playStep(state, *policy, command);
+	}
+	GameState::Snapshot original;
+	playStep(state, *policy, command);
+	state.saveSnapshot(original);
+
+	std::ostringstream out;
+	out << describeDivergence(divergence)
+	    << "differences with the original game:\n";
+	GameState::printDifferences(out, original, divergence.state);
+	if (state.getChecksum() != recording.getChecksums()[divergence.tick])
+	{
+		out << "  the original game doesn't play the step the same again\n";
+	}
+	return out.str();
+}
+
+GameResult
+playGame(const Options &options, int game)
+{
+	std::uint64_t seed = options.seed + game;
+	GameState state(seed, options.rules);
+	auto policy = Policy::create(options.policy, ~seed);
+	Replay recording(seed, TickTime);
+
+	long ticks = 0;
+	while (!state.isGameOver() && ticks < options.maxTicks)
+	{
+		GameState::Command command;
+		bool applied = playStep(state, *policy, command);
+		if (options.verify)
+		{
+			if (applied)
+			{
+				recording.record(ticks, command);
+			}
+			recording.recordChecksum(state.getChecksum());
+		}
+		ticks++;
+	}
+
+	GameResult result{ state.getScore(), state.getLevel(), ticks, {} };
+	if (options.verify)
+	{
+		// a second instance plays the commands alone and must go
+		// through the same states
+		Replay::Divergence divergence;
+		recording.setTickCount(ticks);
+		recording.setLevelSeeds(state.getLevelSeeds());
+		if (recording.findDivergence(divergence))
+		{
+			result.divergence = describeDivergence(options, game, recording, divergence);
+		}
+	}
+	return result;
+}
+
+void
+playReplays(const Options &options)
+{
+	std::vector<Replay> replays;
+	for (const auto &filename: options.replays)
+	{
+		replays.push_back(Replay::load(filename));
+	}
+
+	std::vector<GameResult> results(replays.size());
+	WorkStealingPool pool(options.threads);
+	auto start = std::chrono::steady_clock::now();
+	pool.run(replays.size(), [&](int index, unsigned) {
+		const auto &replay = replays[index];
+		auto state = replay.play();
+		results[index] = { state.getScore(), state.getLevel(), replay.getTickCount(), {} };
+
+		Replay::Divergence divergence;
+		if (replay.findDivergence(divergence))
+		{
+			results[index].divergence = describeDivergence(divergence);
+		}
+	});
+	std::chrono::duration<double> wallTime =
+		std::chrono::steady_clock::now() - start;
+
+	long totalTicks = 0;
+	std::cout << "replay                          score  level     ticks\n";
+	for (unsigned i = 0; i < results.size(); i++)
+	{
+		totalTicks += results[i].ticks;
+		std::cout << std::left << std::setw(28) << options.replays[i] << std::right
+			  << std::setw(9) << results[i].score
+			  << std::setw(7) << results[i].level
+			  << std::setw(10) << results[i].ticks << '\n';
+		if (!results[i].divergence.empty())
+		{
+			std::cout << "  " << results[i].divergence;
+		}
+	}
+	std::cout << std::fixed << std::setprecision(1)
+		  << "\nwall time:  " << wallTime.count() << " s\n"
+		  << "ticks/s:    " << totalTicks / wallTime.count() << '\n';
+}
+
+void
+printReport(const Options &options,
+            std::vector<GameResult> results,
+            const std::vector<WorkStealingPool::WorkerStats> &stats,
+            double wallTime)
+{
+	long totalTicks = 0;
+	double totalScore = 0.0;
+	std::map<int, int> levels;
+	for (const auto &result: results)
+	{
+		totalTicks += result.ticks;
+		totalScore += result.score;
+		levels[result.level]++;
+	}
+
+	// before the results are sorted by score
+	std::ostringstream verification;
+	int diverged = 0;
+	for (unsigned i = 0; i < results.size(); i++)
+	{
+		if (!results[i].divergence.empty())
+		{
+			verification << "\ngame " << i << ' ' << results[i].divergence;
+			diverged++;
+		}
+	}
+	verification << "\nverified:   " << results.size() - diverged
+		     << " games, " << diverged << " diverged\n";
+
+	std::sort(results.begin(), results.end(),
+	          [](const auto &a, const auto &b) { return a.score < b.score; });
+	auto percentile = [&results](int p) {
+		return results[(results.size() - 1) * p / 100].score;
+	};
+
+	std::cout << std::fixed << std::setprecision(1)
+		  << "games:      " << results.size()
+		  << " (" << options.policy << " policy, "
+		  << stats.size() << " threads)\n"
+		  << "wall time:  " << wallTime << " s\n"
+		  << "games/s:    " << results.size() / wallTime << '\n'
+		  << "ticks/s:    " << totalTicks / wallTime << '\n'
+		  << "\nscore:      mean " << totalScore / results.size()
+		  << ", min " << results.front().score
+		  << ", p10 " << percentile(10)
+		  << ", p50 " << percentile(50)
+		  << ", p90 " << percentile(90)
+		  << ", max " << results.back().score << '\n'
+		  << "\nlevel reached:\n";
+	for (auto [level, count]: levels)
+	{
+		double share = 100.0 * count / results.size();
+		std::cout << std::setw(6) << level << ' '
+			  << std::setw(8) << count << ' '
+			  << std::setw(6) << share << "% "
+			  << std::string(static_cast<int>(share / 2), '#') << '\n';
+	}
+
+	if (options.verify)
+	{
+		std::cout << verification.str();
+	}
+
+	std::cout << "\nthread      games   steals    busy\n";
+	for (unsigned i = 0; i < stats.size(); i++)
+	{
+		std::cout << std::setw(6) << i << ' '
+			  << std::setw(10) << stats[i].tasks << ' '
+			  << std::setw(8) << stats[i].steals << ' '
+			  << std::setw(6) << 100.0 * stats[i].busyTime / wallTime << "%\n";
+	}
+}
+
+}
+
+int main(int argc, char **argv)
+{
+	try
+	{
+		auto options = parseOptions(argc, argv);
+		if (!options.replays.empty())
+		{
+			playReplays(options);
+			return 0;
+		}
+		if (options.games <= 0)
+		{
+			throw std::runtime_error("The number of games must be positive");
+		}
+
+		// fail early on a wrong policy name
+		Policy::create(options.policy, options.seed);
+		if (options.verify && !(options.rules == GameState::Rules()))
+		{
+			throw std::runtime_error("The games are verified with the default rules");
+		}
+
+		std::vector<GameResult> results(options.games);
+		WorkStealingPool pool(options.threads);
+
+		auto start = std::chrono::steady_clock::now();
+		auto stats = pool.run(options.games, [&](int game, unsigned) {
+			results[game] = playGame(options, game);
+		});
+		std::chrono::duration<double> wallTime =
+			std::chrono::steady_clock::now() - start;
+
+		printReport(options, std::move(results), stats, wallTime.count());
+		return 0;
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << "Exception caught: " << e.what() << std::endl;
+		return 1;
+	}
+}
@@ -43,8 +43,14 @@ GameOverView::handleEvent(const Event &event)
 	return false;
 }
 
+bool
+GameOverView::hasChanged() const
+{
+	return false;
+}
+
 void
-GameOverView::render(RenderTarget &target)
+GameOverView::render(RenderTarget &target, float)
 {
 	target.draw("G A M E  O V E R !", gameOverLocation, mFont, Color::Yellow);
 }
@@ -0,0 +1,386 @@
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <type_traits>
+
+#include "gamestate.hpp"
+
+namespace
+{
+
+// levels searched ahead by the level generator, a level lasts long
+// enough for the next one to be found except in a fast-forward
+static const int LevelsAhead = 3;
+
+static const char *const TypeNames[] = {
+	"LeftRight", "TopBottom", "LeftTop", "TopRight",
+	"RightBottom", "BottomLeft", "Empty",
+};
+
+std::uint64_t
+mix(std::uint64_t value)
+{
+	// splitmix64 finalizer
+	value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+	return value ^ (value >> 31);
+}
+
+std::uint64_t
+pack(float low, float high)
+{
+	return std::bit_cast<std::uint32_t>(low)
+		| static_cast<std::uint64_t>(std::bit_cast<std::uint32_t>(high)) << 32;
+}
+
+std::uint64_t
+pack(int low, int high)
+{
+	return static_cast<std::uint32_t>(low)
+		| static_cast<std::uint64_t>(static_cast<std::uint32_t>(high)) << 32;
+}
+
+template <typename T>
+void
+printField(std::ostream &out, const char *name, const T &a, const T &b)
+{
+	if (a != b)
+	{
+		out << "  " << name << ": " << a << " != " << b << '\n';
+	}
+}
+
+void
+printPipe(std::ostream &out, const Pipe &pipe)
+{
+	out << TypeNames[pipe.getType()] << (pipe.isFilled() ? " filled" : "");
+}
+
+}
+
+GameState::GameState(std::uint64_t seed)
+	: GameState(seed, Rules())
+{
+}
+
+GameState::GameState(std::uint64_t seed, const Rules &rules)
+	: mSeed(seed)
+	, mRules(rules)
+	, mBoard(seed)
+	, mPlayerScore(0)
+	, mTimeSinceLastInput(0.f)
+	, mTimeSinceLastIncrease(0.f)
+	, mFloodCount(0.f)
+	, mFloodIncreaseAmount(rules.initialFloodIncrease)
+	, mCurrentLevel(0)
+	, mLinesCompleted(0)
+	, mGameOver(false)
+	, mLastScores()
+	, mLevelGenerator(nullptr)
+	, mLevelSeeds()
+{
+}
+
+bool
+GameState::update(float dt, const Command *command)
+{
+	mLastScores.clear();
+
+	mTimeSinceLastInput += dt;
+	mTimeSinceLastIncrease += dt;
+	if (mTimeSinceLastIncrease >= mRules.timeBetweenFloodIncreases)
+	{
+		mTimeSinceLastIncrease -= mRules.timeBetweenFloodIncreases;
+		mFloodCount += mFloodIncreaseAmount;
+		if (mFloodCount > mRules.maxFloodCounter)
+		{
+			mGameOver = true;
+		}
+	}
+
+	bool applied = false;
+	if (mBoard.arePipesAnimating())
+	{
+		mBoard.updateAnimatedPipes(dt);
+	}
+	else
+	{
+		if (command && mTimeSinceLastInput >= mRules.minTimeSinceLastInput
+		    && 0 <= command->x && command->x < Board::BoardWidth
+		    && 0 <= command->y && command->y < Board::BoardHeight)
+		{
+			mBoard.addRotatingPipe(command->x, command->y,
+			                       mBoard.getType(command->x, command->y),
+			                       command->clockwise);
+			mBoard.rotatePipe(command->x, command->y, command->clockwise);
+			mTimeSinceLastInput = 0.f;
+			applied = true;
+		}
+
+		// the chains fade out of the board before it is replaced
+		// by the one of the next level
+		bool levelCompleted = false;
+		mBoard.computeWaterChains();
+		for (int y = 0; y < Board::BoardHeight; y++)
+		{
+			levelCompleted |= checkScoringChain(mBoard.getComputedChain(y));
+		}
+		if (levelCompleted)
+		{
+			startNewLevel();
+		}
+		mBoard.makeNewPipes(true);
+	}
+
+	return applied;
+}
+
+bool
+GameState::acceptsInput() const
+{
+	return !mBoard.arePipesAnimating()
+		&& mTimeSinceLastInput >= mRules.minTimeSinceLastInput;
+}
+
+bool
+GameState::isGameOver() const
+{
+	return mGameOver;
+}
+
+const Board&
+GameState::getBoard() const
+{
+	return mBoard;
+}
+
+const GameState::Rules&
+GameState::getRules() const
+{
+	return mRules;
+}
+
+int
+GameState::getScore() const
+{
+	return mPlayerScore;
+}
+
+int
+GameState::getLevel() const
+{
+	return mCurrentLevel;
+}
+
+float
+GameState::getFloodCount() const
+{
+	return mFloodCount;
+}
+
+std::span<const int>
+GameState::getLastScores() const
+{
+	return mLastScores;
+}
+
+void
+GameState::saveSnapshot(Snapshot &snapshot) const
+{
+	static_assert(std::is_trivially_copyable_v<Snapshot>,
+	              "A snapshot must be a plain blob");
+
+	snapshot.seed = mSeed;
+	mBoard.saveSnapshot(snapshot.board);
+	snapshot.playerScore = mPlayerScore;
+	snapshot.timeSinceLastInput = mTimeSinceLastInput;
+	snapshot.timeSinceLastIncrease = mTimeSinceLastIncrease;
+	snapshot.floodCount = mFloodCount;
+	snapshot.floodIncreaseAmount = mFloodIncreaseAmount;
+	snapshot.currentLevel = mCurrentLevel;
+	snapshot.linesCompleted = mLinesCompleted;
+	snapshot.gameOver = mGameOver;
+}
+
+void
+GameState::restoreSnapshot(const Snapshot &snapshot)
+{
+	mSeed = snapshot.seed;
+	mBoard.restoreSnapshot(snapshot.board);
+	mPlayerScore = snapshot.playerScore;
+	mTimeSinceLastInput = snapshot.timeSinceLastInput;
+	mTimeSinceLastIncrease = snapshot.timeSinceLastIncrease;
+	mFloodCount = snapshot.floodCount;
+	mFloodIncreaseAmount = snapshot.floodIncreaseAmount;
+	mCurrentLevel = snapshot.currentLevel;
+	mLinesCompleted = snapshot.linesCompleted;
+	mGameOver = snapshot.gameOver;
+	mLastScores.clear();
+}
+
+std::uint32_t
+GameState::getChecksum() const
+{
+	auto random = mBoard.getRandom().getState();
+	const std::uint64_t words[] = {
+		mBoard.getHash(),
+		random.state,
+		random.increment,
+		pack(mFloodCount, mFloodIncreaseAmount),
+		pack(mTimeSinceLastInput, mTimeSinceLastIncrease),
+		pack(mPlayerScore, mCurrentLevel),
+		pack(mLinesCompleted, mGameOver),
+	};
+
+	std::uint64_t hash = 0;
+	for (auto word: words)
+	{
+		hash = mix(hash ^ word);
+	}
+	return static_cast<std::uint32_t>(hash ^ (hash >> 32));
+}
+
+void
+GameState::printDifferences(std::ostream &out, const Snapshot &a, const Snapshot &b)
+{
+	printField(out, "seed", a.seed, b.seed);
+	printField(out, "score", a.playerScore, b.playerScore);
+	printField(out, "time since last input", a.timeSinceLastInput, b.timeSinceLastInput);
+	printField(out, "time since last increase", a.timeSinceLastIncrease, b.timeSinceLastIncrease);
+	printField(out, "flood count", a.floodCount, b.floodCount);
+	printField(out, "flood increase", a.floodIncreaseAmount, b.floodIncreaseAmount);
+	printField(out, "level", a.currentLevel, b.currentLevel);
+	printField(out, "lines completed", a.linesCompleted, b.linesCompleted);
+	printField(out, "game over", a.gameOver, b.gameOver);
+	printField(out, "random state", a.board.random.state, b.board.random.state);
+	printField(out, "random increment", a.board.random.increment, b.board.random.increment);
+
+	for (int i = 0; i < Board::BoardWidth * Board::BoardHeight; i++)
+	{
+		const auto &pipeA = a.board.pipes[i];
+		const auto &pipeB = b.board.pipes[i];
+		if (pipeA.getTileIndex() != pipeB.getTileIndex())
+		{
+			out << "  cell (" << i % Board::BoardWidth << ", "
+			    << i / Board::BoardWidth << "): ";
+			printPipe(out, pipeA);
+			out << " != ";
+			printPipe(out, pipeB);
+			out << '\n';
+		}
+	}
+}
+
+int
+GameState::determineScore(int squareCount)
+{
+	return static_cast<int>((std::pow(squareCount / 5.f, 2.f) + squareCount) * 10.f);
+}
+
+bool
+GameState::checkScoringChain(std::span<const glm::ivec2> waterChain)
+{
+	if (waterChain.empty())
+	{
+		return false;
+	}
+
+	auto lastPipe = waterChain.back();
+	if (lastPipe.x != Board::BoardWidth - 1
+	    || !mBoard.hasConnector(lastPipe.x, lastPipe.y, Pipe::Right))
+	{
+		return false;
+	}
+
+	auto score = determineScore(waterChain.size());
+	mLastScores.push_back(score);
+
+	mPlayerScore += score;
+	mFloodCount -= score / 10.f;
+	if (mFloodCount < 0.f)
+	{
+		mFloodCount = 0.f;
+	}
+
+	for (auto pos: waterChain)
+	{
+		mBoard.addFadingPipe(pos.x, pos.y, mBoard.getType(pos.x, pos.y));
+		mBoard.setType(pos.x, pos.y, Pipe::Empty);
+	}
+
+	mLinesCompleted++;
+	return mLinesCompleted >= mRules.linesPerLevel;
+}
+
+void
+GameState::startNewLevel()
+{
+	mCurrentLevel++;
+	mLinesCompleted = 0;
+	mFloodCount = 0.f;
+	mFloodIncreaseAmount += mRules.floodAccelerationPerLevel;
+	mBoard.clear();
+	if (mRules.levelRotations > 0)
+	{
+		mBoard.getRandom().seed(getLevelSeed(mCurrentLevel));
+		prepareLevels();
+	}
+	mBoard.makeNewPipes(false);
+}
+
+void
+GameState::setLevelGenerator(LevelGenerator *generator)
+{
+	mLevelGenerator = generator;
+	prepareLevels();
+}
+
+std::span<const std::uint64_t>
+GameState::getLevelSeeds() const
+{
+	return mLevelSeeds;
+}
+
+void
+GameState::setLevelSeeds(std::span<const std::uint64_t> seeds)
+{
+	mLevelSeeds.assign(seeds.begin(), seeds.end());
+	prepareLevels();
+}
+
+std::uint64_t
+GameState::getLevelSeed(int level)
+{
+	assert(level >= 1 && level <= static_cast<int>(mLevelSeeds.size()) + 1
+	       && "The levels start in order");
+
+	if (level <= static_cast<int>(mLevelSeeds.size()))
+	{
+		return mLevelSeeds[level - 1];
+	}
+
+	std::uint64_t seed;
+	if (!mLevelGenerator)
+	{
+		seed = LevelGenerator::findLevelSeed(mSeed, level, mRules.levelRotations);
+	}
+	else if (!mLevelGenerator->take(mSeed, level, mRules.levelRotations, seed))
+	{
+		seed = LevelGenerator::getRandomSeed(mSeed, level);
+	}
+	mLevelSeeds.push_back(seed);
+	return seed;
+}
+
+void
+GameState::prepareLevels()
+{
+	// the levels whose seed is known aren't searched again
+	int firstLevel = std::max<int>(mCurrentLevel + 1, mLevelSeeds.size() + 1);
+	int count = mCurrentLevel + 1 + LevelsAhead - firstLevel;
+	if (mLevelGenerator && mRules.levelRotations > 0 && count > 0)
+	{
+		mLevelGenerator->prepare(mSeed, firstLevel, count, mRules.levelRotations);
+	}
+}
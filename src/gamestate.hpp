@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <vector>
+
+#include "board.hpp"
+#include "levelgenerator.hpp"
+
+/**
+ * Rules of the game, without any dependency on the window or the
+ * renderer.
+ *
+ * The state advances only when update() is called, so it can be
+ * driven by the GameView at a fixed simulation rate or by a bot as
+ * fast as possible. Every timer and animation is measured in seconds,
+ * so the pace of the game doesn't depend on the rate of the steps.
+ */
+class GameState
+{
+public:
+	struct Command
+	{
+		int x;
+		int y;
+		bool clockwise;
+	};
+
+	struct Rules
+	{
+		float minTimeSinceLastInput = 0.25f;
+		float maxFloodCounter = 100.f;
+		float timeBetweenFloodIncreases = 1.f;
+		float initialFloodIncrease = 0.5f;
+		float floodAccelerationPerLevel = 0.5f;
+		int linesPerLevel = 10;
+
+		// rotations needed at most to score on the board of a new
+		// level, 0 for random boards
+		int levelRotations = 3;
+
+		bool operator==(const Rules &other) const = default;
+	};
+
+	/**
+	 * Everything that changes during a game, in a fixed-size blob
+	 * that can be copied with memcpy. The rules aren't part of it.
+	 */
+	struct Snapshot
+	{
+		std::uint64_t seed;
+		Board::Snapshot board;
+		int playerScore;
+		float timeSinceLastInput;
+		float timeSinceLastIncrease;
+		float floodCount;
+		float floodIncreaseAmount;
+		int currentLevel;
+		int linesCompleted;
+		bool gameOver;
+	};
+
+public:
+	explicit GameState(std::uint64_t seed);
+	GameState(std::uint64_t seed, const Rules &rules);
+
+	/**
+	 * Advance the game by @dt seconds.
+	 *
+	 * @param[in] dt Elapsed time in seconds.
+	 * @param[in] command Rotation requested by the player, it is
+	 *                    ignored if the board doesn't accept input.
+	 *
+	 * @retval true the command was applied.
+	 * @retval false no command or command ignored.
+	 */
+	bool update(float dt, const Command *command = nullptr);
+
+	bool acceptsInput() const;
+	bool isGameOver() const;
+
+	const Board& getBoard() const;
+	const Rules& getRules() const;
+	int getScore() const;
+	int getLevel() const;
+	float getFloodCount() const;
+
+	/**
+	 * Get the scores of the chains completed by the last update().
+	 */
+	std::span<const int> getLastScores() const;
+
+	void saveSnapshot(Snapshot &snapshot) const;
+
+	/**
+	 * Go back to the state of the @snapshot, the game continues
+	 * exactly as it did after the snapshot was saved.
+	 */
+	void restoreSnapshot(const Snapshot &snapshot);
+
+	/**
+	 * Checksum of the board, the score, the flood counter, the
+	 * timers and the state of the generator. It costs a few
+	 * multiplications, the hash of the board being kept up to date
+	 * by the board itself, so it can be taken at every step.
+	 */
+	std::uint32_t getChecksum() const;
+
+	/**
+	 * Print the fields and the cells that differ between @a and @b.
+	 */
+	static void printDifferences(std::ostream &out, const Snapshot &a, const Snapshot &b);
+
+	/**
+	 * Take the boards of the next levels from @generator, it keeps
+	 * a few of them ready ahead and a level that isn't ready gets a
+	 * random board. Without generator the boards are searched when
+	 * the levels start, which takes tens of milliseconds each time.
+	 *
+	 * @param[in] generator Level generator, it must outlive the
+	 *                      game, or nullptr.
+	 */
+	void setLevelGenerator(LevelGenerator *generator);
+
+	/**
+	 * Get the seeds of the boards of the levels started so far, from
+	 * the level 1. They are kept by a rewind, a level started again
+	 * gets the same board.
+	 */
+	std::span<const std::uint64_t> getLevelSeeds() const;
+
+	/**
+	 * Use the @seeds recorded from another game for the boards of
+	 * its levels, the game then plays the same.
+	 */
+	void setLevelSeeds(std::span<const std::uint64_t> seeds);
+
+	static int determineScore(int squareCount);
+
+private:
+	/**
+	 * Score the chain if it reaches the right side of the board.
+	 *
+	 * @retval true the level is completed.
+	 * @retval false the level goes on.
+	 */
+	bool checkScoringChain(std::span<const glm::ivec2> waterChain);
+	void startNewLevel();
+	std::uint64_t getLevelSeed(int level);
+	void prepareLevels();
+
+private:
+	std::uint64_t mSeed;
+	Rules mRules;
+	Board mBoard;
+	int mPlayerScore;
+	float mTimeSinceLastInput;
+
+	float mTimeSinceLastIncrease;
+	float mFloodCount;
+	float mFloodIncreaseAmount;
+
+	int mCurrentLevel;
+	int mLinesCompleted;
+	bool mGameOver;
+
+	std::vector<int> mLastScores;
+	LevelGenerator *mLevelGenerator;
+	std::vector<std::uint64_t> mLevelSeeds;
+};
@@ -1,7 +1,9 @@
+#include <cmath>
+#include <ctime>
 #include <iostream>
+#include <stdexcept>
 
 #include <GLFW/glfw3.h>
-#include <glm/gtc/matrix_transform.hpp>
 
 #include "gameview.hpp"
 
@@ -16,82 +18,202 @@ namespace
 
 static const glm::vec2 BoardOrigin(70.f, 89.f);
 static const glm::vec2 ScorePosition(605.f, 215.f);
-static const float MinTimeSinceLastInput = 0.25f;
 
 static const glm::vec2 WaterPosition(478.f, 338.f);
 static const glm::vec2 WaterSize(244.f, 297.f);
 static const glm::vec2 WaterOverlayStart(85.f, 245.f);
 
-static const float MaxFloodCounter = 100.f;
-static const float TimeBetweenFloodIncreases = 1.f;
-
-static const float FloodAccelerationPerLevel = 0.5f;
 static const glm::vec2 LevelPosition(512.f, 215.f);
 
+// time of play that can be rewound
+static const float RewindTime = 5.f;
+
+// frames drawn between two updates while the pipes are animated
+static const int MaxInterpolatedFrames = 4;
+
+// the hints show the pipe as the best rotation leaves it, see-through,
+// with the score in a corner of the cell
+static const Color HintPipeColor(255, 255, 255, 150);
+static const glm::vec2 HintScoreOffset(2.f, 0.f);
+static const float HintScoreScale = 0.35f;
+
 }
 
-GameView::GameView(ViewStack &stack, const Context &context)
+GameView::GameView(ViewStack &stack, const Context &context,
+                   const Settings &settings)
 	: mViewStack(stack)
 	, mContext(context)
 	, mBackground(context.textures->get(TextureID::Background))
 	, mTileSheet(context.textures->get(TextureID::TileSheet))
-	, mTileSheetSize(mTileSheet.getSize())
-	, mEmptyPipe({1.f, 247.f}, {40.f, 40.f})
-	, mBoard()
-	, mPlayerScore(0)
-	, mTimeSinceLastInput(0.f)
-	, mTimeSinceLastIncrease(0.f)
-	, mFloodCount(0.f)
-	, mFloodIncreaseAmount(0.5f)
-	, mCurrentLevel(0)
-	, mLinesCompleted(0)
+	, mTileRects()
+	, mStaticLayer()
+	, mStaticLayerDirty(true)
+	, mPlayback(settings.replay)
+	, mNextInput(0)
+	, mDiverged(false)
+	, mRecordPath(settings.recordPath)
+	, mRecording()
+	, mTick(0)
+	, mFramesSinceUpdate(0)
+	, mSeed(mPlayback
+	        ? mPlayback->getSeed()
+	        : static_cast<std::uint64_t>(std::time(nullptr)))
+	, mLevelGenerator()
+	, mState(mSeed)
+	, mHistory()
+	, mScoreZooms()
+	, mPolicyName(settings.fastForward.policy)
+	, mPolicy()
+	, mFastForwardTicks(0)
+	, mFastForwardLevel(0)
+	, mHintEngine()
+	, mShowHints(false)
+	, mHintHash(0)
+{
+	// normalize the texture coordinates once
+	glm::vec2 tileSheetSize = mTileSheet.getSize();
+	for (int type = 0; type <= Pipe::Empty; type++)
+	{
+		for (bool filled: { false, true })
+		{
+			Pipe pipe(static_cast<Pipe::Type>(type), filled);
+			FloatRect srcRect = pipe.getSourceRect();
+			srcRect.pos /= tileSheetSize;
+			srcRect.size /= tileSheetSize;
+			mTileRects[pipe.getTileIndex()] = srcRect;
+		}
+	}
+
+	if (mPlayback)
+	{
+		mState.setLevelSeeds(mPlayback->getLevelSeeds());
+	}
+	mState.setLevelGenerator(&mLevelGenerator);
+	startFastForward(settings.fastForward.ticks, settings.fastForward.level);
+}
+
+GameView::~GameView()
 {
-	mEmptyPipe.pos /= mTileSheetSize;
-	mEmptyPipe.size /= mTileSheetSize;
+	// the game has been left before its end
+	try
+	{
+		saveRecording();
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << e.what() << std::endl;
+	}
 }
 
 bool
 GameView::update(float dt)
 {
-	mTimeSinceLastInput += dt;
-	mTimeSinceLastIncrease += dt;
-	if (mTimeSinceLastIncrease >= TimeBetweenFloodIncreases)
+	if (mPlayback && dt != mPlayback->getStep())
 	{
-		mTimeSinceLastIncrease -= TimeBetweenFloodIncreases;
-		mFloodCount += mFloodIncreaseAmount;
-		if (mFloodCount > MaxFloodCounter)
-		{
-			mViewStack.pushView(ViewID::GameOver);
-		}
+		throw std::runtime_error("The replay has been recorded at another simulation rate");
 	}
-
-	if (mBoard.arePipesAnimating())
+	if (!mRecordPath.empty() && !mRecording)
 	{
-		mBoard.updateAnimatedPipes();
+		mRecording.emplace(mSeed, dt);
 	}
-	else
+	if (mHistory.getCapacity() == 0)
 	{
-		if (mTimeSinceLastInput >= MinTimeSinceLastInput)
+		mHistory = RingBuffer<HistoryEntry>(std::ceil(RewindTime / dt));
+	}
+	mFramesSinceUpdate = 0;
+
+	// the game runs backward while the rewind key is held
+	if (!mPolicy && mContext.window->isKeyPressed(GLFW_KEY_BACKSPACE))
+	{
+		if (!mHistory.empty())
 		{
-			double mx, my;
-			unsigned mb;
-			mContext.window->getMouseState(mx, my, mb);
-			handleMouseInput(mx, my, mb);
+			stepBack();
 		}
+		requestHints();
+		return true;
+	}
+
+	auto &entry = mHistory.push();
+	mState.saveSnapshot(entry.state);
 
-		mBoard.resetWater();
-		for (int y = 0; y < Board::BoardHeight; y++)
+	GameState::Command command;
+	bool hasCommand = getCommand(command);
+	entry.commandApplied = mState.update(dt, hasCommand ? &command : nullptr);
+	if (mRecording)
+	{
+		if (entry.commandApplied)
 		{
-			checkScoringChain(mBoard.getWaterChain(y));
+			mRecording->record(mTick, command);
 		}
-		mBoard.makeNewPipes(true);
+		mRecording->recordChecksum(mState.getChecksum());
+	}
+	checkPlayback();
+	mTick++;
+	for (auto score: mState.getLastScores())
+	{
+		mScoreZooms.emplace_back(
+			std::to_string(score),
+			Color(255, 0, 0, 102));
+	}
+	if (mState.isGameOver())
+	{
+		saveRecording();
+		mViewStack.pushView(ViewID::GameOver);
 	}
 
 	updateScoreZooms(dt);
+	updateFastForward();
+	requestHints();
 
 	return true;
 }
 
+bool
+GameView::isFastForwarding() const
+{
+	return mPolicy != nullptr;
+}
+
+bool
+GameView::hasChanged() const
+{
+	// a display faster than the updates draws the animations between
+	// two of them, a few frames at most so a covered view settles
+	bool animating = mState.getBoard().arePipesAnimating() || !mScoreZooms.empty();
+	return mFramesSinceUpdate == 0
+		|| (animating && mFramesSinceUpdate < MaxInterpolatedFrames);
+}
+
+void
+GameView::startFastForward(long ticks, int level)
+{
+	if (ticks <= 0 && level <= mState.getLevel())
+	{
+		return;
+	}
+	mPolicy = Policy::create(mPolicyName, ~mSeed);
+	mFastForwardTicks = ticks;
+	mFastForwardLevel = level;
+}
+
+void
+GameView::updateFastForward()
+{
+	if (!mPolicy)
+	{
+		return;
+	}
+
+	// back to the player when the first limit is reached
+	bool ticksDone = mFastForwardTicks > 0 && --mFastForwardTicks == 0;
+	bool levelDone = mFastForwardLevel > 0 && mState.getLevel() >= mFastForwardLevel;
+	if (ticksDone || levelDone)
+	{
+		mPolicy.reset();
+		mScoreZooms.clear();
+	}
+}
+
 void
 GameView::updateScoreZooms(float dt)
 {
@@ -119,20 +241,57 @@ GameView::handleEvent(const Event &event)
 		mViewStack.pushView(ViewID::Paused);
 		return true;
 	}
+	else if (ep && ep->key == GLFW_KEY_U)
+	{
+		undo();
+		return true;
+	}
+	else if (ep && ep->key == GLFW_KEY_H)
+	{
+		// the hint thread is started the first time it is needed
+		if (!mHintEngine)
+		{
+			mHintEngine = std::make_unique<HintEngine>();
+		}
+		mShowHints = !mShowHints;
+		mHintHash = 0;
+		return true;
+	}
+	else if (std::holds_alternative<WindowResized>(event)
+	         || std::holds_alternative<FramebufferResized>(event))
+	{
+		mStaticLayerDirty = true;
+		return false;
+	}
+	else if (ep && ep->key == GLFW_KEY_F)
+	{
+		// fast-forward to the next level, or stop fast-forwarding
+		if (mPolicy)
+		{
+			mPolicy.reset();
+		}
+		else
+		{
+			startFastForward(0, mState.getLevel() + 1);
+		}
+		return true;
+	}
 	return false;
 }
 
 void
-GameView::render(RenderTarget &target)
+GameView::render(RenderTarget &target, float alpha)
 {
+	mFramesSinceUpdate++;
 	target.clear(Color::Magenta);
 
-	// background
-	target.draw(mBackground, glm::vec2(0.f), mBackground.getSize());
+	// background and empty board
+	drawStaticLayer(target);
+
 	// flood level
 	glm::vec2 bgSize = mBackground.getSize();
 
-	float waterHeight = 244.f * mFloodCount / 100;
+	float waterHeight = 244.f * mState.getFloodCount() / 100;
 	FloatRect srcRect = {
 		{ 85.f, 245.f + 244.f - waterHeight },
 		{ 297.f, waterHeight },
@@ -146,196 +305,328 @@ GameView::render(RenderTarget &target)
 	// normalize the texture coordinates
 	srcRect.pos /= bgSize;
 	srcRect.size /= bgSize;
+	target.setTexture(&mBackground);
 	target.draw(srcRect, dstRect.pos, dstRect.size, Color(255,255,255,180));
 
 	// pipes
+	const auto &board = mState.getBoard();
 	target.setTexture(&mTileSheet);
-	auto pair = std::make_pair(0, 0);
-	for (pair.first = 0; pair.first < mBoard.BoardWidth; pair.first++)
+	const auto &animations = board.getAnimations();
+	for (int x = 0; x < board.BoardWidth; x++)
 	{
-		for (pair.second = 0; pair.second < mBoard.BoardHeight; pair.second++)
+		for (int y = 0; y < board.BoardHeight; y++)
 		{
-			auto pos = glm::vec2(pair.first, pair.second) * Pipe::Size + BoardOrigin;
-
-			drawEmptyPipe(target, pos);
+			auto pos = glm::vec2(x, y) * Pipe::Size + BoardOrigin;
 
-			if (auto it = mBoard.mRotatingPipes.find(pair); it != mBoard.mRotatingPipes.end())
+			auto kinds = animations.getKinds(x, y);
+			if (kinds & animations.Rotating)
 			{
-				drawRotatingPipe(target, pos, *it->second);
+				drawRotatingPipe(target, pos, animations.getRotatingPipe(x, y),
+				                 animations.getRotation(x, y, alpha));
 			}
-			else if (auto it = mBoard.mFadingPipes.find(pair); it != mBoard.mFadingPipes.end())
+			else if (kinds & animations.Fading)
 			{
-				drawFadingPipe(target, pos, *it->second);
+				drawFadingPipe(target, pos, animations.getFadingPipe(x, y),
+				               animations.getAlphaLevel(x, y, alpha));
 			}
-			else if (auto it = mBoard.mFallingPipes.find(pair); it != mBoard.mFallingPipes.end())
+			else if (kinds & animations.Falling)
 			{
-				drawFallingPipe(target, pos, *it->second);
+				drawFallingPipe(target, pos, animations.getFallingPipe(x, y),
+				                animations.getVerticalOffset(x, y, alpha));
 			}
 			else
 			{
-				drawStandardPipe(target, pos, mBoard.getPipe(pair.first, pair.second));
+				drawStandardPipe(target, pos, board.getPipe(x, y));
 			}
 		}
 	}
 
+	if (mShowHints)
+	{
+		drawHints(target);
+	}
+
 	// level
 	auto &font = mContext.fonts->get(FontID::Pericles36);
-	target.draw(std::to_string(mCurrentLevel), LevelPosition, font, Color::Black);
+	target.draw(std::to_string(mState.getLevel()), LevelPosition, font, Color::Black);
 
 	// points
-	target.draw(std::to_string(mPlayerScore), ScorePosition, font, Color::Black);
+	target.draw(std::to_string(mState.getScore()), ScorePosition, font, Color::Black);
 
 	// scorezoom
-        auto winCenter = glm::vec3(mContext.window->getSize(), 0.f) * 0.5f;
+	auto winCenter = glm::vec2(mContext.window->getSize()) * 0.5f;
 	for (auto& scoreZoom: mScoreZooms)
 	{
 		auto textSize = font.getSize(scoreZoom.text);
-		auto scale = scoreZoom.getScale();
-		glm::mat4 mat4 = glm::translate(
-			glm::scale(
-				glm::translate(
-					glm::mat4(1.f),
-					winCenter),
-				glm::vec3(scale, scale, 1.f)),
-			glm::vec3(textSize * -0.5f, 0.f));
-		target.draw(scoreZoom.text, mat4, font, scoreZoom.drawColor);
+		auto scale = scoreZoom.getScale(alpha);
+		target.draw(scoreZoom.text, winCenter - textSize * scale * 0.5f, scale,
+		            font, scoreZoom.drawColor);
 	}
 }
 
+void
+GameView::drawStaticLayer(RenderTarget &target)
+{
+	// the layer has a texel per pixel of the framebuffer and is
+	// drawn in window units like the rest of the frame
+	glm::vec2 size = mContext.window->getSize();
+	auto pixelSize = mContext.window->getFramebufferSize();
+	if (pixelSize.x == 0 || pixelSize.y == 0)
+	{
+		// minimized
+		return;
+	}
+
+	if (mStaticLayerDirty || mStaticLayer.getSize() != pixelSize)
+	{
+		mStaticLayer.create(pixelSize);
+		target.beginOffscreen(mStaticLayer, size);
+		target.draw(mBackground, glm::vec2(0.f), mBackground.getSize());
+		target.setTexture(&mTileSheet);
+		for (int x = 0; x < Board::BoardWidth; x++)
+		{
+			for (int y = 0; y < Board::BoardHeight; y++)
+			{
+				drawEmptyPipe(target, glm::vec2(x, y) * Pipe::Size + BoardOrigin);
+			}
+		}
+		target.endOffscreen();
+		mStaticLayerDirty = false;
+	}
+
+	target.setTexture(&mStaticLayer.getTexture());
+	target.draw(mStaticLayer.getTextureRect(), glm::vec2(0.f), size);
+}
+
 void
 GameView::drawEmptyPipe(RenderTarget &target, glm::vec2 pos)
 {
-	target.draw(mEmptyPipe, pos, Pipe::Size);
+	target.draw(mTileRects[Pipe().getTileIndex()], pos, Pipe::Size);
 }
 
 void
 GameView::drawStandardPipe(RenderTarget &target, glm::vec2 pos, const Pipe &pipe)
 {
-	FloatRect srcRect = pipe.getSourceRect();
-	srcRect.pos /= mTileSheetSize;
-	srcRect.size /= mTileSheetSize;
-
-	target.draw(srcRect, pos, Pipe::Size);
+	target.draw(mTileRects[pipe.getTileIndex()], pos, Pipe::Size);
 }
 
 void
-GameView::drawFallingPipe(RenderTarget &target, glm::vec2 pos, const FallingPipe &pipe)
+GameView::drawFallingPipe(RenderTarget &target, glm::vec2 pos, const Pipe &pipe,
+                          float verticalOffset)
 {
-	pos.y -= pipe.getVerticalOffset();
-
-	FloatRect srcRect = pipe.getSourceRect();
-	srcRect.pos /= mTileSheetSize;
-	srcRect.size /= mTileSheetSize;
+	pos.y -= verticalOffset;
 
-	target.draw(srcRect, pos, Pipe::Size);
+	target.draw(mTileRects[pipe.getTileIndex()], pos, Pipe::Size);
 }
 
 void
-GameView::drawFadingPipe(RenderTarget &target, glm::vec2 pos, const FadingPipe &pipe)
+GameView::drawFadingPipe(RenderTarget &target, glm::vec2 pos, const Pipe &pipe,
+                         float alphaLevel)
 {
-	FloatRect srcRect = pipe.getSourceRect();
-	srcRect.pos /= mTileSheetSize;
-	srcRect.size /= mTileSheetSize;
+	const auto &srcRect = mTileRects[pipe.getTileIndex()];
 
-	Color color(255, 255, 255, 255.f * pipe.getAlphaLevel());
+	Color color(255, 255, 255, 255.f * alphaLevel);
 	target.draw(srcRect, pos, Pipe::Size, color);
 }
 
 void
-GameView::drawRotatingPipe(RenderTarget &target, glm::vec2 pos, const RotatingPipe &pipe)
+GameView::drawRotatingPipe(RenderTarget &target, glm::vec2 pos, const Pipe &pipe,
+                           float rotation)
+{
+	const auto &srcRect = mTileRects[pipe.getTileIndex()];
+
+	target.draw(srcRect, pos, Pipe::Size, rotation, glm::vec2(.5f));
+}
+
+bool
+GameView::getCommand(GameState::Command &command)
 {
-	auto mat4 = glm::translate(
-		glm::rotate(
-			glm::translate(
-				glm::mat4(1.f),
-				glm::vec3(Pipe::Size * .5f, 0.f) + glm::vec3(pos, 0.f)),
-			pipe.getRotation(),
-			glm::vec3(0.f, 0.f, -1.f)),
-		glm::vec3(Pipe::Size * -.5f, 0.f));
-
-	FloatRect srcRect = pipe.getSourceRect();
-	srcRect.pos /= mTileSheetSize;
-	srcRect.size /= mTileSheetSize;
-
-	target.draw(srcRect, mat4, Pipe::Size);
+	if (mPlayback)
+	{
+		auto inputs = mPlayback->getInputs();
+		if (mNextInput < inputs.size() && inputs[mNextInput].tick == mTick)
+		{
+			command = inputs[mNextInput++].command;
+			return true;
+		}
+		if (mTick < mPlayback->getTickCount())
+		{
+			return false;
+		}
+
+		// the player takes over at the end of the replay
+		mPlayback.reset();
+	}
+	if (mPolicy)
+	{
+		return mState.acceptsInput() && mPolicy->getCommand(mState, command);
+	}
+	return getMouseCommand(command);
 }
 
-int
-GameView::determineScore(int squareCount)
+void
+GameView::saveRecording()
 {
-	return static_cast<int>((std::pow(squareCount / 5.f, 2.f) + squareCount) * 10.f);
+	if (mRecording)
+	{
+		mRecording->setTickCount(mTick);
+		mRecording->setLevelSeeds(mState.getLevelSeeds());
+		auto recording = std::move(*mRecording);
+		mRecording.reset();
+		recording.save(mRecordPath);
+	}
 }
 
 void
-GameView::checkScoringChain(const std::vector<glm::ivec2> &waterChain)
+GameView::requestHints()
 {
-	if (waterChain.empty())
+	// the hints are computed once the board has settled, a rotation
+	// changes the hash and makes the previous ones stale
+	const auto &board = mState.getBoard();
+	if (mShowHints && !mPolicy && !board.arePipesAnimating()
+	    && board.getHash() != mHintHash)
 	{
-		return;
+		mHintEngine->request(board);
+		mHintHash = board.getHash();
 	}
+}
 
-	auto lastPipe = waterChain.back();
-	if (lastPipe.x != Board::BoardWidth - 1
-	    || !mBoard.hasConnector(lastPipe.x, lastPipe.y, Pipe::Right))
+void
+GameView::checkPlayback()
+{
+	if (!mPlayback || mDiverged)
 	{
 		return;
 	}
 
-	auto score = determineScore(waterChain.size());
-	mScoreZooms.emplace_back(
-		std::to_string(score),
-		Color(255, 0, 0, 102));
-
-	mPlayerScore += score;
-	mFloodCount -= score / 10.f;
-	if (mFloodCount < 0.f)
+	auto checksums = mPlayback->getChecksums();
+	if (mTick < static_cast<long>(checksums.size())
+	    && mState.getChecksum() != checksums[mTick])
 	{
-		mFloodCount = 0.f;
+		// only the checksum of the recorded state is known, the
+		// step that diverged is shown instead
+		GameState::Snapshot state;
+		mState.saveSnapshot(state);
+		std::cerr << "The replay diverged at tick " << mTick
+			  << ", changes of the step:\n";
+		GameState::printDifferences(std::cerr, mHistory.back().state, state);
+		mDiverged = true;
 	}
+}
 
-	mLinesCompleted++;
-	if (mLinesCompleted >= 10)
+bool
+GameView::stepBack()
+{
+	const auto &entry = mHistory.back();
+	bool commandApplied = entry.commandApplied;
+	mState.restoreSnapshot(entry.state);
+	mHistory.pop();
+	mTick--;
+	mScoreZooms.clear();
+
+	// the commands of the steps undone are forgotten, or played
+	// again if they come from the replay
+	if (mRecording)
 	{
-		startNewLevel();
+		mRecording->truncate(mTick);
+	}
+	if (mPlayback)
+	{
+		auto inputs = mPlayback->getInputs();
+		while (mNextInput > 0 && inputs[mNextInput - 1].tick >= mTick)
+		{
+			mNextInput--;
+		}
 	}
+	return commandApplied;
+}
 
-	for (auto pos: waterChain)
+void
+GameView::undo()
+{
+	// back to the step before the last rotation still in the history
+	for (auto i = mHistory.getSize(); i > 0; i--)
 	{
-		mBoard.addFadingPipe(pos.x, pos.y, mBoard.getType(pos.x, pos.y));
-		mBoard.setType(pos.x, pos.y, Pipe::Empty);
+		if (mHistory[i - 1].commandApplied)
+		{
+			while (!stepBack())
+			{
+			}
+			return;
+		}
 	}
 }
 
 void
-GameView::handleMouseInput(double mx, double my, unsigned mb)
+GameView::drawHints(RenderTarget &target)
 {
-	int x = static_cast<int>((mx - BoardOrigin.x) / Pipe::PipeWidth);
-	int y = static_cast<int>((my - BoardOrigin.y) / Pipe::PipeHeight);
+	const auto &board = mState.getBoard();
+	const auto &hints = mHintEngine->getHints();
+	if (!hints.valid || hints.hash != board.getHash() || board.arePipesAnimating())
+	{
+		return;
+	}
+
+	auto getPosition = [](int cell) {
+		return glm::vec2(cell % Board::BoardWidth, cell / Board::BoardWidth)
+			* Pipe::Size + BoardOrigin;
+	};
+
+	// the better the rotation of a cell scores the greener it gets
+	for (int i = 0; i < HintEngine::CellCount; i++)
+	{
+		if (hints.scores[i] > 0)
+		{
+			auto alpha = 60 + 120 * hints.scores[i] / hints.bestScore;
+			target.draw(getPosition(i), Pipe::Size, Color(0, 255, 0, alpha));
+		}
+	}
 
-	if  (0 <= x && x < Board::BoardWidth && 0 <= y && y < Board::BoardHeight)
+	target.setTexture(&mTileSheet);
+	for (int i = 0; i < HintEngine::CellCount; i++)
 	{
-		if (mb & 1)
+		if (hints.scores[i] > 0)
 		{
-			mBoard.addRotatingPipe(x, y, mBoard.getType(x, y), false);
-			mBoard.rotatePipe(x, y, false);
-			mTimeSinceLastInput = 0.f;
+			const auto &pipe = board.getPipe(i % Board::BoardWidth, i / Board::BoardWidth);
+			auto type = Pipe::getRotated(pipe.getType(), hints.clockwise[i]);
+			if (hints.halfTurn[i])
+			{
+				type = Pipe::getRotated(type, hints.clockwise[i]);
+			}
+			auto tileIndex = Pipe(type, true).getTileIndex();
+			target.draw(mTileRects[tileIndex], getPosition(i), Pipe::Size, HintPipeColor);
 		}
-		if (mb & 2)
+	}
+
+	auto &font = mContext.fonts->get(FontID::Pericles36);
+	for (int i = 0; i < HintEngine::CellCount; i++)
+	{
+		if (hints.scores[i] > 0)
 		{
-			mBoard.addRotatingPipe(x, y, mBoard.getType(x, y), true);
-			mBoard.rotatePipe(x, y, true);
-			mTimeSinceLastInput = 0.f;
+			target.draw(std::to_string(hints.scores[i]), getPosition(i) + HintScoreOffset,
+			            HintScoreScale, font, Color::Black);
 		}
 	}
 }
 
-void
-GameView::startNewLevel()
+bool
+GameView::getMouseCommand(GameState::Command &command) const
 {
-	mCurrentLevel++;
-	mLinesCompleted = 0;
-	mFloodCount = 0.f;
-	mFloodIncreaseAmount += FloodAccelerationPerLevel;
-	mBoard.clear();
-	mBoard.makeNewPipes(false);
+	double mx, my;
+	unsigned mb;
+	mContext.window->getMouseState(mx, my, mb);
+
+	command.x = static_cast<int>((mx - BoardOrigin.x) / Pipe::PipeWidth);
+	command.y = static_cast<int>((my - BoardOrigin.y) / Pipe::PipeHeight);
+	if (mb & 1)
+	{
+		command.clockwise = false;
+		return true;
+	}
+	if (mb & 2)
+	{
+		command.clockwise = true;
+		return true;
+	}
+	return false;
 }
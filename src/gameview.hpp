@@ -1,56 +1,122 @@
 #pragma once
 
-#include <vector>
+#include <array>
+#include <filesystem>
 #include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
 #include "view.hpp"
 #include "viewstack.hpp"
-#include "board.hpp"
+#include "gamestate.hpp"
+#include "hintengine.hpp"
+#include "policy.hpp"
+#include "rendertexture.hpp"
+#include "replay.hpp"
+#include "ringbuffer.hpp"
 #include "scorezoom.hpp"
 
 class GameView: public View
 {
 public:
-	GameView(ViewStack &stack, const Context &context);
-	virtual ~GameView() override = default;
+	/**
+	 * Fast-forward at the start of the game: the @policy plays until
+	 * @ticks updates have passed or the @level is reached, a zero
+	 * disables the limit and both zero disable the fast-forward.
+	 */
+	struct FastForward
+	{
+		std::string policy = "greedy";
+		long ticks = 0;
+		int level = 0;
+	};
+
+	struct Settings
+	{
+		FastForward fastForward;
+
+		// file written with the replay of each game, none if empty
+		std::filesystem::path recordPath;
+
+		// game played back before handing over to the player
+		std::shared_ptr<const Replay> replay;
+	};
+
+public:
+	GameView(ViewStack &stack, const Context &context, const Settings &settings);
+	virtual ~GameView() override;
 
 	virtual bool update(float dt) override;
 	virtual bool handleEvent(const Event &event) override;
-	virtual void render(RenderTarget &target) override;
+	virtual bool isFastForwarding() const override;
+	virtual bool hasChanged() const override;
+	virtual void render(RenderTarget &target, float alpha) override;
 
 private:
-	static int determineScore(int squareCount);
-	void checkScoringChain(const std::vector<glm::ivec2> &waterChain);
-	void handleMouseInput(double mx, double my, unsigned mb);
+	struct HistoryEntry
+	{
+		GameState::Snapshot state;
+		bool commandApplied;
+	};
+
+private:
+	bool getCommand(GameState::Command &command);
+	bool getMouseCommand(GameState::Command &command) const;
+	void saveRecording();
+
+	bool stepBack();
+	void undo();
+	void checkPlayback();
+	void requestHints();
+
+	void startFastForward(long ticks, int level);
+	void updateFastForward();
 
 	void updateScoreZooms(float dt);
 
+	void drawStaticLayer(RenderTarget &target);
 	void drawEmptyPipe(RenderTarget &target, glm::vec2 pos);
 	void drawStandardPipe(RenderTarget &target, glm::vec2 pos, const Pipe &pipe);
-	void drawFallingPipe(RenderTarget &target, glm::vec2 pos, const FallingPipe &pipe);
-	void drawRotatingPipe(RenderTarget &target, glm::vec2 pos, const RotatingPipe &pipe);
-	void drawFadingPipe(RenderTarget &target, glm::vec2 pos, const FadingPipe &pipe);
-
-	void startNewLevel();
+	void drawFallingPipe(RenderTarget &target, glm::vec2 pos, const Pipe &pipe,
+	                     float verticalOffset);
+	void drawRotatingPipe(RenderTarget &target, glm::vec2 pos, const Pipe &pipe,
+	                      float rotation);
+	void drawFadingPipe(RenderTarget &target, glm::vec2 pos, const Pipe &pipe,
+	                    float alphaLevel);
+	void drawHints(RenderTarget &target);
 
 private:
 	ViewStack &mViewStack;
 	const Context &mContext;
 	Texture &mBackground;
 	Texture &mTileSheet;
-	glm::vec2 mTileSheetSize;
-	FloatRect mEmptyPipe;
+	std::array<FloatRect, Pipe::TileCount> mTileRects;
 
-	Board mBoard;
-	int mPlayerScore;
-	float mTimeSinceLastInput;
+	// background and empty board, drawn again on a resize
+	RenderTexture mStaticLayer;
+	bool mStaticLayerDirty;
 
-	float mTimeSinceLastIncrease;
-	float mFloodCount;
-	float mFloodIncreaseAmount;
-
-	int mCurrentLevel;
-	int mLinesCompleted;
+	std::shared_ptr<const Replay> mPlayback;
+	std::size_t mNextInput;
+	bool mDiverged;
+	std::filesystem::path mRecordPath;
+	std::optional<Replay> mRecording;
+	long mTick;
+	int mFramesSinceUpdate;
 
+	std::uint64_t mSeed;
+	LevelGenerator mLevelGenerator;
+	GameState mState;
+	RingBuffer<HistoryEntry> mHistory;
 	std::vector<ScoreZoom> mScoreZooms;
+
+	std::string mPolicyName;
+	Policy::Ptr mPolicy;
+	long mFastForwardTicks;
+	int mFastForwardLevel;
+
+	std::unique_ptr<HintEngine> mHintEngine;
+	bool mShowHints;
+	std::uint64_t mHintHash;
 };
@@ -0,0 +1,80 @@
+#include <algorithm>
+
+#include "hintengine.hpp"
+
+HintEngine::HintEngine()
+	: mRequests()
+	, mResults()
+	, mRequestCount(0)
+	, mStop(false)
+	, mThread(&HintEngine::run, this)
+{
+}
+
+HintEngine::~HintEngine()
+{
+	mStop.store(true, std::memory_order_relaxed);
+	mRequestCount.fetch_add(1, std::memory_order_release);
+	mRequestCount.notify_one();
+	mThread.join();
+}
+
+void
+HintEngine::request(const Board &board)
+{
+	mRequests.getWriteBuffer() = board.getBitBoard();
+	mRequests.publish();
+	mRequestCount.fetch_add(1, std::memory_order_release);
+	mRequestCount.notify_one();
+}
+
+const HintEngine::Hints&
+HintEngine::getHints()
+{
+	mResults.update();
+	return mResults.getReadBuffer();
+}
+
+void
+HintEngine::run()
+{
+	SuccessorEvaluator evaluator;
+	std::uint32_t seen = 0;
+	for (;;)
+	{
+		mRequestCount.wait(seen, std::memory_order_acquire);
+		if (mStop.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+		seen = mRequestCount.load(std::memory_order_acquire);
+		if (!mRequests.update())
+		{
+			continue;
+		}
+
+		const auto &board = mRequests.getReadBuffer();
+		auto &hints = mResults.getWriteBuffer();
+		hints = Hints();
+		for (const auto &successor: evaluator.evaluate(board, true))
+		{
+			const auto &command = successor.command;
+			int cell = command.y * Board::BoardWidth + command.x;
+			if (successor.score > hints.scores[cell])
+			{
+				hints.scores[cell] = successor.score;
+				hints.clockwise[cell] = command.clockwise;
+				hints.halfTurn[cell] = successor.halfTurn;
+			}
+			hints.bestScore = std::max(hints.bestScore, successor.score);
+		}
+		hints.valid = true;
+		hints.hash = board.getHash();
+
+		// a newer board has been requested meanwhile
+		if (!mRequests.hasUpdate())
+		{
+			mResults.publish();
+		}
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "board.hpp"
+#include "successorevaluator.hpp"
+#include "triplebuffer.hpp"
+
+/**
+ * Best score of a rotation of every cell, computed on a worker
+ * thread. The rotations are a click either way or, for the bends, a
+ * half turn.
+ *
+ * The boards are handed to the worker and the hints handed back
+ * through TripleBuffers, so neither request() nor getHints() ever
+ * blocks the caller. The hints of a board replaced by a newer request
+ * before the worker is done are dropped, and every hint carries the
+ * hash of its board so the reader can tell when it is stale.
+ */
+class HintEngine
+{
+public:
+	typedef BitBoard<Board::BoardWidth, Board::BoardHeight> HintBoard;
+
+	static constexpr int CellCount = Board::BoardWidth * Board::BoardHeight;
+
+	struct Hints
+	{
+		bool valid = false;
+		std::uint64_t hash = 0;
+
+		// best score of the rotations of each cell, 0 if none
+		// scores, and the rotation giving it: the direction of the
+		// click, clicked twice for a half turn
+		int scores[CellCount] = {};
+		bool clockwise[CellCount] = {};
+		bool halfTurn[CellCount] = {};
+		int bestScore = 0;
+	};
+
+public:
+	HintEngine();
+	~HintEngine();
+
+	HintEngine(const HintEngine &) = delete;
+	HintEngine& operator=(const HintEngine &) = delete;
+
+	/**
+	 * Compute the hints of @board, it replaces the previous request
+	 * if the worker didn't pick it up yet.
+	 */
+	void request(const Board &board);
+
+	/**
+	 * Get the last hints published. They may be of an older board,
+	 * check their hash.
+	 */
+	const Hints& getHints();
+
+private:
+	void run();
+
+private:
+	TripleBuffer<HintBoard> mRequests;
+	TripleBuffer<Hints> mResults;
+	std::atomic<std::uint32_t> mRequestCount;
+	std::atomic<bool> mStop;
+
+	std::thread mThread;
+};
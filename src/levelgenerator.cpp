@@ -0,0 +1,172 @@
+#include <algorithm>
+
+#include "levelgenerator.hpp"
+#include "planner.hpp"
+
+namespace
+{
+
+// a wider beam finds hardly more boards that score and costs as much
+// more; a board passes only if a scoring chain is found
+static const int BeamWidth = 16;
+
+// the candidate of the last attempt is taken if none passes
+static const int MaxAttempts = 1000;
+
+std::uint64_t
+mix(std::uint64_t value)
+{
+	// splitmix64
+	value += 0x9E3779B97F4A7C15ULL;
+	value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+	return value ^ (value >> 31);
+}
+
+std::uint64_t
+getCandidate(std::uint64_t seed, int level, int attempt)
+{
+	return mix(seed ^ mix(static_cast<std::uint64_t>(level) << 32 | attempt));
+}
+
+}
+
+LevelGenerator::LevelGenerator(unsigned threadCount)
+	: mJobs()
+	, mStop(false)
+	, mThreads()
+{
+	for (unsigned i = 0; i < std::max(threadCount, 1u); i++)
+	{
+		mThreads.emplace_back(&LevelGenerator::run, this);
+	}
+}
+
+LevelGenerator::~LevelGenerator()
+{
+	{
+		std::lock_guard lock(mMutex);
+		mStop = true;
+	}
+	mWorkCondition.notify_all();
+	for (auto &thread: mThreads)
+	{
+		thread.join();
+	}
+}
+
+void
+LevelGenerator::prepare(std::uint64_t seed, int firstLevel, int count, int rotations)
+{
+	{
+		std::lock_guard lock(mMutex);
+		for (int level = firstLevel; level < firstLevel + count; level++)
+		{
+			auto queued = std::find_if(mJobs.begin(), mJobs.end(), [&](const Job &job) {
+				return job.seed == seed && job.level == level && job.rotations == rotations;
+			});
+			if (queued == mJobs.end())
+			{
+				mJobs.push_back({seed, level, rotations, false, false, 0});
+			}
+		}
+	}
+	mWorkCondition.notify_all();
+}
+
+bool
+LevelGenerator::take(std::uint64_t seed, int level, int rotations, std::uint64_t &levelSeed)
+{
+	std::lock_guard lock(mMutex);
+
+	// the levels before are over
+	std::erase_if(mJobs, [&](const Job &job) {
+		return job.seed == seed && job.level < level && !job.running;
+	});
+
+	auto it = std::find_if(mJobs.begin(), mJobs.end(), [&](const Job &job) {
+		return job.seed == seed && job.level == level && job.rotations == rotations;
+	});
+	if (it == mJobs.end())
+	{
+		return false;
+	}
+	if (it->done)
+	{
+		levelSeed = it->result;
+		mJobs.erase(it);
+		return true;
+	}
+
+	// a running search is left to finish and dropped with the
+	// levels before the next one taken
+	if (!it->running)
+	{
+		mJobs.erase(it);
+	}
+	return false;
+}
+
+std::uint64_t
+LevelGenerator::getRandomSeed(std::uint64_t seed, int level)
+{
+	return getCandidate(seed, level, 0);
+}
+
+std::uint64_t
+LevelGenerator::findLevelSeed(std::uint64_t seed, int level, int rotations)
+{
+	Planner::Settings settings;
+	settings.depth = rotations;
+	settings.beamWidth = BeamWidth;
+	settings.budget = std::chrono::milliseconds(0);
+
+	std::uint64_t candidate = 0;
+	for (int attempt = 0; attempt < MaxAttempts; attempt++)
+	{
+		candidate = getCandidate(seed, level, attempt);
+		Board board(candidate);
+		board.makeNewPipes(false);
+		if (Planner::search(board.getBitBoard(), settings).value >= Planner::ScoreWeight)
+		{
+			break;
+		}
+	}
+	return candidate;
+}
+
+void
+LevelGenerator::run()
+{
+	std::unique_lock lock(mMutex);
+	for (;;)
+	{
+		auto next = mJobs.end();
+		mWorkCondition.wait(lock, [&]() {
+			next = std::find_if(mJobs.begin(), mJobs.end(), [](const Job &job) {
+				return !job.running && !job.done;
+			});
+			return mStop || next != mJobs.end();
+		});
+		if (mStop)
+		{
+			return;
+		}
+
+		next->running = true;
+		auto job = *next;
+		lock.unlock();
+		auto result = findLevelSeed(job.seed, job.level, job.rotations);
+		lock.lock();
+
+		// the job may have moved in the queue, but not left it
+		// while running
+		auto it = std::find_if(mJobs.begin(), mJobs.end(), [&](const Job &other) {
+			return other.seed == job.seed && other.level == job.level
+				&& other.rotations == job.rotations;
+		});
+		it->running = false;
+		it->done = true;
+		it->result = result;
+	}
+}
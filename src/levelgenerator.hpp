@@ -0,0 +1,86 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Search of the boards of the levels that can score quickly.
+ *
+ * The board of a level is the one drawn from a seed, and the seed is
+ * the first of a sequence derived from the seed of the game and the
+ * level whose board has a scoring chain within a few rotations. The
+ * search is deterministic, so every player of a game gets the same
+ * boards whether they come from the worker threads or from
+ * findLevelSeed() on the calling thread.
+ *
+ * The worker threads search the levels queued with prepare() ahead of
+ * time, take() then only picks up the result. It never searches nor
+ * waits, a level that isn't ready gets a random board instead, so the
+ * boards depend on the timing and a game must record its level seeds
+ * to be played again.
+ */
+class LevelGenerator
+{
+public:
+	explicit LevelGenerator(unsigned threadCount = 1);
+	~LevelGenerator();
+
+	LevelGenerator(const LevelGenerator &) = delete;
+	LevelGenerator& operator=(const LevelGenerator &) = delete;
+
+	/**
+	 * Queue the search of the @count levels from @firstLevel of
+	 * the game @seed, the levels already queued are skipped.
+	 */
+	void prepare(std::uint64_t seed, int firstLevel, int count, int rotations);
+
+	/**
+	 * Get the seed of the board of the @level of the game @seed if
+	 * its search is over, the search of a level taken too early is
+	 * dropped.
+	 *
+	 * @retval true the seed is in @levelSeed.
+	 * @retval false the level isn't ready.
+	 */
+	bool take(std::uint64_t seed, int level, int rotations, std::uint64_t &levelSeed);
+
+	/**
+	 * Get the seed of a random board of the @level of the game
+	 * @seed, without any search.
+	 */
+	static std::uint64_t getRandomSeed(std::uint64_t seed, int level);
+
+	/**
+	 * Search the seed of the board of the @level of the game
+	 * @seed on the calling thread.
+	 *
+	 * @param[in] rotations Rotations allowed to make a scoring
+	 *                      chain on the board.
+	 */
+	static std::uint64_t findLevelSeed(std::uint64_t seed, int level, int rotations);
+
+private:
+	struct Job
+	{
+		std::uint64_t seed;
+		int level;
+		int rotations;
+		bool running;
+		bool done;
+		std::uint64_t result;
+	};
+
+	void run();
+
+private:
+	std::mutex mMutex;
+	std::condition_variable mWorkCondition;
+	std::deque<Job> mJobs;
+	bool mStop;
+
+	std::vector<std::thread> mThreads;
+};
@@ -40,8 +40,20 @@ PauseView::handleEvent(const Event &event)
 	return false;
 }
 
+bool
+PauseView::hasChanged() const
+{
+	return false;
+}
+
+bool
+PauseView::needsUpdates() const
+{
+	return false;
+}
+
 void
-PauseView::render(RenderTarget &target)
+PauseView::render(RenderTarget &target, float)
 {
 	target.draw(Obscured.pos, Obscured.size, Color::Black);
 
@@ -2,16 +2,6 @@
 
 namespace
 {
-static unsigned typeDirections[] = {
-	Pipe::Left | Pipe::Right,
-	Pipe::Top | Pipe::Bottom,
-	Pipe::Left | Pipe::Top,
-	Pipe::Top | Pipe::Right,
-	Pipe::Right | Pipe::Bottom,
-	Pipe::Bottom | Pipe::Left,
-	0,
-};
-
 static const int textureOffsetX = 1;
 static const int textureOffsetY = 1;
 static const int texturePaddingX = 1;
@@ -19,67 +9,50 @@ static const int texturePaddingY = 1;
 }
 
 Pipe::Pipe(Type type, bool filled)
-	: mType(type)
-	, mFilled(filled)
+	: mBits(type | (filled ? FilledBit : 0))
 {
 }
 
 Pipe::Type
 Pipe::getType() const
 {
-	return mType;
+	return static_cast<Type>(mBits & TypeMask);
 }
 
 void
 Pipe::setType(Type type)
 {
-	mType = type;
+	mBits = (mBits & ~TypeMask) | type;
 }
 
 bool
 Pipe::isFilled() const
 {
-	return mFilled;
+	return mBits & FilledBit;
 }
 
 void
 Pipe::setFilled(bool filled)
 {
-	mFilled = filled;
+	mBits = filled ? mBits | FilledBit : mBits & ~FilledBit;
 }
 
 void
 Pipe::rotate(bool clockwise)
 {
-	switch (mType)
-	{
-	case LeftRight:
-		mType = TopBottom;
-		break;
-	case TopBottom:
-		mType = LeftRight;
-		break;
-	case LeftTop:
-		mType = clockwise ? TopRight : BottomLeft;
-		break;
-	case TopRight:
-		mType = clockwise ? RightBottom : LeftTop;
-		break;
-	case RightBottom:
-		mType = clockwise ? BottomLeft : TopRight;
-		break;
-	case BottomLeft:
-		mType = clockwise ? LeftTop : RightBottom;
-		break;
-	case Empty:
-		break;
-	}
+	setType(getRotated(getType(), clockwise));
 }
 
 bool
 Pipe::hasConnector(Direction dir) const
 {
-	return (typeDirections[mType] & dir) != 0;
+	return (getConnectors(getType()) & dir) != 0;
+}
+
+int
+Pipe::getTileIndex() const
+{
+	return getType() * 2 + isFilled();
 }
 
 FloatRect
@@ -88,12 +61,12 @@ Pipe::getSourceRect() const
 	int x = textureOffsetX;
 	int y = textureOffsetY;
 
-	if (mFilled)
+	if (isFilled())
 	{
 		x += PipeWidth + texturePaddingX;
 	}
 
-	y += mType * (PipeHeight + texturePaddingY);
+	y += getType() * (PipeHeight + texturePaddingY);
 
 	return {{x, y}, {PipeWidth, PipeHeight}};
 }
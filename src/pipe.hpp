@@ -1,7 +1,13 @@
 #pragma once
 
+#include <cstdint>
+
 #include "rect.hpp"
 
+/**
+ * A cell of the board packed in a single byte: 3 bits for the type,
+ * 1 for the water and the rest free for flags.
+ */
 class Pipe
 {
 public:
@@ -27,6 +33,10 @@ public:
 		BottomLeft,
 		Empty,
 	};
+
+	// one tile per type, without and with water
+	static constexpr int TileCount = (Empty + 1) * 2;
+
 public:
 	explicit Pipe(Type type = Empty, bool filled = false);
 
@@ -41,7 +51,48 @@ public:
 	bool hasConnector(Direction dir) const;
 	FloatRect getSourceRect() const;
 
+	/**
+	 * Index of the tile of the pipe in [0, TileCount).
+	 */
+	int getTileIndex() const;
+
+	static constexpr unsigned getConnectors(Type type);
+	static constexpr Type getRotated(Type type, bool clockwise);
+
+private:
+	static constexpr std::uint8_t TypeMask = 0x07;
+	static constexpr std::uint8_t FilledBit = 0x08;
+
+	static constexpr std::uint8_t Connectors[] = {
+		Left | Right,
+		Top | Bottom,
+		Left | Top,
+		Top | Right,
+		Right | Bottom,
+		Bottom | Left,
+		0,
+	};
+
+	// indexed by clockwise and by type
+	static constexpr Type Rotations[2][Empty + 1] = {
+		{ TopBottom, LeftRight, BottomLeft, LeftTop, TopRight, RightBottom, Empty },
+		{ TopBottom, LeftRight, TopRight, RightBottom, BottomLeft, LeftTop, Empty },
+	};
+
 private:
-	Type mType;
-	bool mFilled;
+	std::uint8_t mBits;
 };
+
+static_assert(sizeof(Pipe) == 1, "A pipe must fit in a byte");
+
+constexpr unsigned
+Pipe::getConnectors(Type type)
+{
+	return Connectors[type];
+}
+
+constexpr Pipe::Type
+Pipe::getRotated(Type type, bool clockwise)
+{
+	return Rotations[clockwise][type];
+}
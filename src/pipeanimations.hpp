@@ -0,0 +1,308 @@
+#pragma once
+
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+#include "pipe.hpp"
+
+/**
+ * Animations of the pipes of a board, with one slot per cell.
+ *
+ * Each cell has a mask of the animations running on it, and each kind
+ * of animation keeps its parameters in its own arrays. A cell can be
+ * falling, rotating and fading at the same time. Adding an animation
+ * never allocates, and an update is a linear sweep over the cells.
+ *
+ * The animations advance with the simulation time and keep their
+ * values of the previous step, so the renderer can interpolate them
+ * between two steps with an @alpha in [0, 1].
+ */
+template <int Width, int Height>
+class PipeAnimations
+{
+public:
+	enum Kind
+	{
+		Falling  = 1 << 0,
+		Rotating = 1 << 1,
+		Fading   = 1 << 2,
+	};
+
+public:
+	PipeAnimations();
+
+	void clear();
+
+	bool isAnimating() const;
+	bool isAnimating(Kind kind) const;
+
+	void addFalling(int x, int y, Pipe::Type type, int verticalOffset);
+	void addRotating(int x, int y, Pipe::Type type, bool clockwise);
+	void addFading(int x, int y, Pipe::Type type);
+
+	/**
+	 * Advance by @dt seconds the animations of the @kinds and drop
+	 * the ones that are over.
+	 */
+	void update(unsigned kinds, float dt);
+
+	/**
+	 * Get the Kind bits of the animations of the cell (x, y).
+	 */
+	unsigned getKinds(int x, int y) const;
+
+	Pipe getFallingPipe(int x, int y) const;
+	float getVerticalOffset(int x, int y, float alpha = 1.f) const;
+
+	Pipe getRotatingPipe(int x, int y) const;
+	float getRotation(int x, int y, float alpha = 1.f) const;
+
+	Pipe getFadingPipe(int x, int y) const;
+	float getAlphaLevel(int x, int y, float alpha = 1.f) const;
+
+private:
+	static constexpr int CellCount = Width * Height;
+	static constexpr int KindCount = 3;
+
+	// pixels and alpha per second
+	static constexpr float FallSpeed = 300.f;
+	static constexpr float FadeSpeed = 1.2f;
+	static constexpr float RotationTime = 1.f / 6.f;
+
+	// the steps don't add up exactly, an animation ending within
+	// this time ends on the current step
+	static constexpr float TimeTolerance = 1e-4f;
+
+	static constexpr int getIndex(int x, int y);
+
+	void start(int index, Kind kind);
+	void stop(int index, Kind kind);
+
+private:
+	std::uint8_t mKinds[CellCount];
+	int mCounts[KindCount];
+
+	std::uint8_t mFallingTypes[CellCount];
+	float mVerticalOffsets[CellCount];
+	float mPreviousOffsets[CellCount];
+
+	std::uint8_t mRotatingTypes[CellCount];
+	bool mClockwise[CellCount];
+	float mRotationTimes[CellCount];
+	float mPreviousRotationTimes[CellCount];
+
+	std::uint8_t mFadingTypes[CellCount];
+	float mAlphaLevels[CellCount];
+	float mPreviousAlphaLevels[CellCount];
+};
+
+template <int Width, int Height>
+PipeAnimations<Width, Height>::PipeAnimations()
+	: mKinds()
+	, mCounts()
+	, mFallingTypes()
+	, mVerticalOffsets()
+	, mPreviousOffsets()
+	, mRotatingTypes()
+	, mClockwise()
+	, mRotationTimes()
+	, mPreviousRotationTimes()
+	, mFadingTypes()
+	, mAlphaLevels()
+	, mPreviousAlphaLevels()
+{
+}
+
+template <int Width, int Height>
+void
+PipeAnimations<Width, Height>::clear()
+{
+	for (auto &kinds: mKinds)
+	{
+		kinds = 0;
+	}
+	for (auto &count: mCounts)
+	{
+		count = 0;
+	}
+}
+
+template <int Width, int Height>
+bool
+PipeAnimations<Width, Height>::isAnimating() const
+{
+	return mCounts[0] + mCounts[1] + mCounts[2] > 0;
+}
+
+template <int Width, int Height>
+bool
+PipeAnimations<Width, Height>::isAnimating(Kind kind) const
+{
+	return mCounts[std::countr_zero(static_cast<unsigned>(kind))] > 0;
+}
+
+template <int Width, int Height>
+void
+PipeAnimations<Width, Height>::addFalling(int x, int y, Pipe::Type type, int verticalOffset)
+{
+	int index = getIndex(x, y);
+	start(index, Falling);
+	mFallingTypes[index] = type;
+	mVerticalOffsets[index] = verticalOffset;
+	mPreviousOffsets[index] = verticalOffset;
+}
+
+template <int Width, int Height>
+void
+PipeAnimations<Width, Height>::addRotating(int x, int y, Pipe::Type type, bool clockwise)
+{
+	int index = getIndex(x, y);
+	start(index, Rotating);
+	mRotatingTypes[index] = type;
+	mClockwise[index] = clockwise;
+	mRotationTimes[index] = 0.f;
+	mPreviousRotationTimes[index] = 0.f;
+}
+
+template <int Width, int Height>
+void
+PipeAnimations<Width, Height>::addFading(int x, int y, Pipe::Type type)
+{
+	int index = getIndex(x, y);
+	start(index, Fading);
+	mFadingTypes[index] = type;
+	mAlphaLevels[index] = 1.f;
+	mPreviousAlphaLevels[index] = 1.f;
+}
+
+template <int Width, int Height>
+void
+PipeAnimations<Width, Height>::update(unsigned kinds, float dt)
+{
+	for (int i = 0; i < CellCount; i++)
+	{
+		if (mKinds[i] == 0)
+		{
+			continue;
+		}
+
+		// the paused animations stay still between the two steps
+		mPreviousOffsets[i] = mVerticalOffsets[i];
+		mPreviousRotationTimes[i] = mRotationTimes[i];
+		mPreviousAlphaLevels[i] = mAlphaLevels[i];
+
+		auto active = mKinds[i] & kinds;
+		if (active & Falling)
+		{
+			mVerticalOffsets[i] -= FallSpeed * dt;
+			if (mVerticalOffsets[i] <= FallSpeed * TimeTolerance)
+			{
+				mVerticalOffsets[i] = 0.f;
+				stop(i, Falling);
+			}
+		}
+		if (active & Rotating)
+		{
+			mRotationTimes[i] += dt;
+			if (mRotationTimes[i] >= RotationTime - TimeTolerance)
+			{
+				mRotationTimes[i] = RotationTime;
+				stop(i, Rotating);
+			}
+		}
+		if (active & Fading)
+		{
+			mAlphaLevels[i] -= FadeSpeed * dt;
+			if (mAlphaLevels[i] <= FadeSpeed * TimeTolerance)
+			{
+				mAlphaLevels[i] = 0.f;
+				stop(i, Fading);
+			}
+		}
+	}
+}
+
+template <int Width, int Height>
+unsigned
+PipeAnimations<Width, Height>::getKinds(int x, int y) const
+{
+	return mKinds[getIndex(x, y)];
+}
+
+template <int Width, int Height>
+Pipe
+PipeAnimations<Width, Height>::getFallingPipe(int x, int y) const
+{
+	return Pipe(static_cast<Pipe::Type>(mFallingTypes[getIndex(x, y)]));
+}
+
+template <int Width, int Height>
+float
+PipeAnimations<Width, Height>::getVerticalOffset(int x, int y, float alpha) const
+{
+	int index = getIndex(x, y);
+	return std::lerp(mPreviousOffsets[index], mVerticalOffsets[index], alpha);
+}
+
+template <int Width, int Height>
+Pipe
+PipeAnimations<Width, Height>::getRotatingPipe(int x, int y) const
+{
+	return Pipe(static_cast<Pipe::Type>(mRotatingTypes[getIndex(x, y)]));
+}
+
+template <int Width, int Height>
+float
+PipeAnimations<Width, Height>::getRotation(int x, int y, float alpha) const
+{
+	int index = getIndex(x, y);
+	float time = std::lerp(mPreviousRotationTimes[index], mRotationTimes[index], alpha);
+	float rotation = -3.141592654f / 2.f * time / RotationTime;
+	return mClockwise[index] ? rotation : 3.141592654f * 2.f - rotation;
+}
+
+template <int Width, int Height>
+Pipe
+PipeAnimations<Width, Height>::getFadingPipe(int x, int y) const
+{
+	return Pipe(static_cast<Pipe::Type>(mFadingTypes[getIndex(x, y)]), true);
+}
+
+template <int Width, int Height>
+float
+PipeAnimations<Width, Height>::getAlphaLevel(int x, int y, float alpha) const
+{
+	int index = getIndex(x, y);
+	return std::lerp(mPreviousAlphaLevels[index], mAlphaLevels[index], alpha);
+}
+
+template <int Width, int Height>
+constexpr int
+PipeAnimations<Width, Height>::getIndex(int x, int y)
+{
+	assert(0 <= y && y < Height && 0 <= x && x < Width
+	       && "Coordinates out of the board");
+
+	return y * Width + x;
+}
+
+template <int Width, int Height>
+void
+PipeAnimations<Width, Height>::start(int index, Kind kind)
+{
+	if (!(mKinds[index] & kind))
+	{
+		mKinds[index] |= kind;
+		mCounts[std::countr_zero(static_cast<unsigned>(kind))]++;
+	}
+}
+
+template <int Width, int Height>
+void
+PipeAnimations<Width, Height>::stop(int index, Kind kind)
+{
+	mKinds[index] &= ~kind;
+	mCounts[std::countr_zero(static_cast<unsigned>(kind))]--;
+}
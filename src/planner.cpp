@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <utility>
+
+#include "planner.hpp"
+
+namespace
+{
+
+struct Node
+{
+	Planner::SearchBoard board;
+	int value;
+	int parent;
+	GameState::Command move;
+};
+
+/**
+ * Set of the hashes reached by a search, open addressing with linear
+ * probing; zero marks the empty slots and is stored on the side.
+ */
+class HashSet
+{
+public:
+	HashSet()
+		: mSlots(1024, 0)
+		, mCount(0)
+		, mHasZero(false)
+	{
+	}
+
+	bool insert(std::uint64_t hash)
+	{
+		if (hash == 0)
+		{
+			return !std::exchange(mHasZero, true);
+		}
+		if (mCount * 2 >= mSlots.size())
+		{
+			grow();
+		}
+		auto mask = mSlots.size() - 1;
+		for (auto i = hash & mask; ; i = (i + 1) & mask)
+		{
+			if (mSlots[i] == hash)
+			{
+				return false;
+			}
+			if (mSlots[i] == 0)
+			{
+				mSlots[i] = hash;
+				mCount++;
+				return true;
+			}
+		}
+	}
+
+private:
+	void grow()
+	{
+		std::vector<std::uint64_t> slots(mSlots.size() * 2, 0);
+		std::swap(slots, mSlots);
+		mCount = 0;
+		for (auto hash: slots)
+		{
+			if (hash != 0)
+			{
+				insert(hash);
+			}
+		}
+	}
+
+private:
+	std::vector<std::uint64_t> mSlots;
+	std::size_t mCount;
+	bool mHasZero;
+};
+
+bool
+isStraight(unsigned connectors)
+{
+	return connectors == (Pipe::Left | Pipe::Right)
+		|| connectors == (Pipe::Top | Pipe::Bottom);
+}
+
+}
+
+Planner::Plan
+Planner::search(const SearchBoard &board, const Settings &settings,
+                TranspositionTable *table)
+{
+	auto deadline = std::chrono::steady_clock::now() + settings.budget;
+	bool limited = settings.budget.count() > 0;
+
+	std::vector<glm::ivec2> chain;
+	std::vector<Node> nodes;
+	std::vector<Node> children;
+	std::vector<int> beam;
+	std::vector<int> order;
+	HashSet seen;
+	SearchBoard scratch;
+
+	Node best{board, 0, -1, {}};
+	best.board.resetWater();
+	seen.insert(best.board.getHash());
+	scratch = best.board;
+	best.value = evaluate(scratch, chain);
+	nodes.push_back(best);
+	beam.push_back(0);
+	int evaluated = 1;
+	int cacheHits = 0;
+
+	for (int ply = 0; ply < settings.depth && !beam.empty(); ply++)
+	{
+		children.clear();
+		for (int index: beam)
+		{
+			if (limited && std::chrono::steady_clock::now() >= deadline)
+			{
+				break;
+			}
+
+			const Node parent = nodes[index];
+			for (int y = 0; y < Board::BoardHeight; y++)
+			{
+				for (int x = 0; x < Board::BoardWidth; x++)
+				{
+					auto connectors = parent.board.getConnectors(x, y);
+					if (connectors == 0)
+					{
+						continue;
+					}
+
+					bool straight = isStraight(connectors);
+					for (int clockwise = straight; clockwise < 2; clockwise++)
+					{
+						// an undone move or a different move order
+						// gives a hash already seen
+						Node child{parent.board, 0, index, {x, y, clockwise != 0}};
+						child.board.rotate(x, y, clockwise);
+						auto hash = child.board.getHash();
+						if (!seen.insert(hash))
+						{
+							continue;
+						}
+
+						if (table && table->probe(hash, child.value))
+						{
+							cacheHits++;
+						}
+						else
+						{
+							// keep the hash of the states free of water
+							scratch = child.board;
+							child.value = evaluate(scratch, chain);
+							evaluated++;
+							if (table)
+							{
+								table->store(hash, child.value);
+							}
+						}
+						children.push_back(child);
+					}
+				}
+			}
+		}
+
+		order.resize(children.size());
+		for (unsigned i = 0; i < order.size(); i++)
+		{
+			order[i] = i;
+		}
+		auto byValue = [&children](int a, int b) {
+			return children[a].value > children[b].value;
+		};
+		if (order.size() > static_cast<unsigned>(settings.beamWidth))
+		{
+			std::nth_element(order.begin(), order.begin() + settings.beamWidth,
+			                 order.end(), byValue);
+			order.resize(settings.beamWidth);
+		}
+
+		beam.clear();
+		for (int i: order)
+		{
+			// the shorter sequence wins on equal values
+			if (children[i].value > best.value)
+			{
+				best = children[i];
+			}
+			beam.push_back(nodes.size());
+			nodes.push_back(children[i]);
+		}
+	}
+
+	Plan plan{{}, best.value, evaluated, cacheHits};
+	for (auto node = best; node.parent >= 0; node = nodes[node.parent])
+	{
+		plan.moves.push_back(node.move);
+	}
+	std::reverse(plan.moves.begin(), plan.moves.end());
+	return plan;
+}
+
+int
+Planner::evaluate(SearchBoard &board, std::vector<glm::ivec2> &chain)
+{
+	board.resetWater();
+
+	int value = 0;
+	for (int y = 0; y < Board::BoardHeight; y++)
+	{
+		chain.clear();
+		board.getWaterChain(y, chain);
+		if (chain.empty())
+		{
+			continue;
+		}
+
+		auto last = chain.back();
+		if (last.x == Board::BoardWidth - 1
+		    && board.hasConnector(last.x, last.y, Pipe::Right))
+		{
+			value += GameState::determineScore(chain.size()) * ScoreWeight;
+			continue;
+		}
+		for (auto pos: chain)
+		{
+			value += pos.x + 1;
+		}
+	}
+	return value;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include "bitboard.hpp"
+#include "board.hpp"
+#include "gamestate.hpp"
+#include "transpositiontable.hpp"
+
+/**
+ * Beam search over the rotations of the pipes of a board.
+ *
+ * The search states are BitBoard copies, a few dozen bytes each
+ * without any animation state, evaluated with the same water chains
+ * and scores of the game. Every ply keeps only the best states and
+ * the result is the sequence of rotations that leads to the best
+ * state found within the time budget. The states reached by more than
+ * one move order are expanded only once and the values already
+ * computed are taken from a TranspositionTable.
+ *
+ * The search runs on the calling thread, the callers bound it with
+ * the budget of the Settings.
+ */
+class Planner
+{
+public:
+	typedef BitBoard<Board::BoardWidth, Board::BoardHeight> SearchBoard;
+
+	// weight of the scoring chains in the values, a value at least
+	// this large has a scoring chain
+	static constexpr int ScoreWeight = 1000;
+
+	struct Settings
+	{
+		int depth = 3;
+		int beamWidth = 64;
+		std::chrono::milliseconds budget{50}; // zero for no limit
+	};
+
+	struct Plan
+	{
+		std::vector<GameState::Command> moves;
+		int value;
+		int evaluated;
+		int cacheHits;
+	};
+
+public:
+	Planner() = delete;
+
+	/**
+	 * Run the search on the calling thread.
+	 *
+	 * @param[in] table Cache of the values, optional, it can be
+	 *                  shared with other searches.
+	 */
+	static Plan search(const SearchBoard &board, const Settings &settings,
+	                   TranspositionTable *table = nullptr);
+
+	/**
+	 * Value of @board: the scoring chains weigh the most, the
+	 * other water counts more the closer it gets to the right edge.
+	 *
+	 * @param[in,out] board Board to evaluate, its water is reset.
+	 * @param[in] chain Scratch buffer.
+	 */
+	static int evaluate(SearchBoard &board, std::vector<glm::ivec2> &chain);
+};
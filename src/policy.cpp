@@ -0,0 +1,102 @@
+#include <stdexcept>
+
+#include "policy.hpp"
+
+namespace
+{
+
+// no time budget, the games must only depend on their seed
+static const Planner::Settings GreedySettings = { 1, 1, std::chrono::milliseconds(0) };
+static const Planner::Settings BeamSettings = { 3, 16, std::chrono::milliseconds(0) };
+static const unsigned TableSizeLog2 = 16;
+
+}
+
+Policy::Ptr
+Policy::create(const std::string &name, std::uint64_t seed)
+{
+	if (name == "idle")
+	{
+		return std::make_unique<IdlePolicy>();
+	}
+	if (name == "random")
+	{
+		return std::make_unique<RandomPolicy>(seed);
+	}
+	if (name == "greedy")
+	{
+		return std::make_unique<PlannerPolicy>(seed, GreedySettings);
+	}
+	if (name == "beam")
+	{
+		return std::make_unique<PlannerPolicy>(seed, BeamSettings);
+	}
+	throw std::runtime_error("Unknown policy " + name);
+}
+
+bool
+IdlePolicy::getCommand(const GameState &, GameState::Command &)
+{
+	return false;
+}
+
+RandomPolicy::RandomPolicy(std::uint64_t seed)
+	: mRandom(seed)
+{
+}
+
+bool
+RandomPolicy::getCommand(const GameState &, GameState::Command &command)
+{
+	command.x = mRandom.nextInt(Board::BoardWidth);
+	command.y = mRandom.nextInt(Board::BoardHeight);
+	command.clockwise = mRandom.nextInt(2);
+	return true;
+}
+
+PlannerPolicy::PlannerPolicy(std::uint64_t seed, const Planner::Settings &settings)
+	: mRandom(seed)
+	, mSettings(settings)
+	, mMoves()
+	, mNextMove(0)
+	, mExpected()
+	, mTable(TableSizeLog2)
+	, mSuccessors()
+{
+}
+
+bool
+PlannerPolicy::getCommand(const GameState &state, GameState::Command &command)
+{
+	// a rotation that scores right away is always taken
+	auto successors = mSuccessors.evaluate(state.getBoard());
+	if (!successors.empty() && successors.front().score > 0)
+	{
+		command = successors.front().command;
+		mMoves.clear();
+		return true;
+	}
+
+	auto board = state.getBoard().getBitBoard();
+	board.resetWater();
+	if (mNextMove >= mMoves.size() || board != mExpected)
+	{
+		auto plan = Planner::search(board, mSettings, &mTable);
+		mMoves = std::move(plan.moves);
+		mNextMove = 0;
+	}
+
+	if (mNextMove < mMoves.size())
+	{
+		command = mMoves[mNextMove++];
+		mExpected = board;
+		mExpected.rotate(command.x, command.y, command.clockwise);
+	}
+	else
+	{
+		command.x = mRandom.nextInt(Board::BoardWidth);
+		command.y = mRandom.nextInt(Board::BoardHeight);
+		command.clockwise = mRandom.nextInt(2);
+	}
+	return true;
+}
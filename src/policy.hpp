@@ -0,0 +1,88 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gamestate.hpp"
+#include "planner.hpp"
+#include "random.hpp"
+#include "successorevaluator.hpp"
+
+/**
+ * Player that drives a GameState without any human input.
+ */
+class Policy
+{
+public:
+	typedef std::unique_ptr<Policy> Ptr;
+
+public:
+	virtual ~Policy() = default;
+
+	/**
+	 * Choose the next rotation for @state.
+	 *
+	 * @param[in] state Game to play, it accepts input.
+	 * @param[out] command Rotation to apply.
+	 *
+	 * @retval true a command has been chosen.
+	 * @retval false nothing to do this tick.
+	 */
+	virtual bool getCommand(const GameState &state, GameState::Command &command) = 0;
+
+	/**
+	 * Create the policy called @name ("idle", "random", "greedy"
+	 * or "beam").
+	 *
+	 * @throw std::runtime_error if the policy doesn't exist.
+	 */
+	static Ptr create(const std::string &name, std::uint64_t seed);
+};
+
+/**
+ * Never touches the board.
+ */
+class IdlePolicy: public Policy
+{
+public:
+	virtual bool getCommand(const GameState &state, GameState::Command &command) override;
+};
+
+/**
+ * Rotates a random pipe.
+ */
+class RandomPolicy: public Policy
+{
+public:
+	explicit RandomPolicy(std::uint64_t seed);
+
+	virtual bool getCommand(const GameState &state, GameState::Command &command) override;
+
+private:
+	Random mRandom;
+};
+
+/**
+ * Plays the rotation that scores the most right now if there is one,
+ * otherwise the rotations of the plan found by the Planner or a random
+ * rotation when no sequence improves the board. The plan is followed
+ * until the board changes in a way it didn't expect. With a depth of
+ * one it is a greedy player.
+ */
+class PlannerPolicy: public Policy
+{
+public:
+	PlannerPolicy(std::uint64_t seed, const Planner::Settings &settings);
+
+	virtual bool getCommand(const GameState &state, GameState::Command &command) override;
+
+private:
+	Random mRandom;
+	Planner::Settings mSettings;
+	std::vector<GameState::Command> mMoves;
+	unsigned mNextMove;
+	Planner::SearchBoard mExpected;
+	TranspositionTable mTable;
+	SuccessorEvaluator mSuccessors;
+};
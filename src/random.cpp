@@ -0,0 +1,76 @@
+#include <cassert>
+
+#include "random.hpp"
+
+namespace
+{
+static const std::uint64_t Multiplier = 6364136223846793005ULL;
+}
+
+Random::Random(std::uint64_t seed, std::uint64_t stream)
+	: mState()
+{
+	this->seed(seed, stream);
+}
+
+void
+Random::seed(std::uint64_t seed, std::uint64_t stream)
+{
+	mState.state = 0;
+	mState.increment = (stream << 1) | 1;
+	next();
+	mState.state += seed;
+	next();
+}
+
+std::uint32_t
+Random::next()
+{
+	auto old = mState.state;
+	mState.state = old * Multiplier + mState.increment;
+	auto xorshifted = static_cast<std::uint32_t>(((old >> 18) ^ old) >> 27);
+	auto rot = static_cast<std::uint32_t>(old >> 59);
+	return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+int
+Random::nextInt(int exclusiveMax)
+{
+	assert(exclusiveMax > 0 && "Invalid range");
+
+	// Lemire's multiply and shift, rejecting the biased values
+	auto bound = static_cast<std::uint32_t>(exclusiveMax);
+	auto product = static_cast<std::uint64_t>(next()) * bound;
+	auto low = static_cast<std::uint32_t>(product);
+	if (low < bound)
+	{
+		auto threshold = -bound % bound;
+		while (low < threshold)
+		{
+			product = static_cast<std::uint64_t>(next()) * bound;
+			low = static_cast<std::uint32_t>(product);
+		}
+	}
+	return static_cast<int>(product >> 32);
+}
+
+void
+Random::fill(std::span<std::uint8_t> values, int exclusiveMax)
+{
+	for (auto &value: values)
+	{
+		value = static_cast<std::uint8_t>(nextInt(exclusiveMax));
+	}
+}
+
+Random::State
+Random::getState() const
+{
+	return mState;
+}
+
+void
+Random::setState(const State &state)
+{
+	mState = state;
+}
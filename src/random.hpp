@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+/**
+ * PCG32 pseudo-random number generator.
+ *
+ * Small and fast enough to be owned by every board, with an
+ * explicit seed so that the same seed always gives the same game.
+ */
+class Random
+{
+public:
+	struct State
+	{
+		std::uint64_t state;
+		std::uint64_t increment;
+	};
+
+public:
+	explicit Random(std::uint64_t seed = 0, std::uint64_t stream = 0);
+
+	void seed(std::uint64_t seed, std::uint64_t stream = 0);
+
+	std::uint32_t next();
+
+	/**
+	 * Get an integer uniformly distributed in [0, exclusiveMax).
+	 */
+	int nextInt(int exclusiveMax);
+
+	/**
+	 * Fill @values with integers uniformly distributed in
+	 * [0, exclusiveMax), the same values that as many calls to
+	 * nextInt() would give.
+	 */
+	void fill(std::span<std::uint8_t> values, int exclusiveMax);
+
+	State getState() const;
+	void setState(const State &state);
+
+private:
+	State mState;
+};
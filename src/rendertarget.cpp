@@ -1,5 +1,7 @@
-#include <iostream>
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <iostream>
 
 #include <GL/glew.h>
 
@@ -12,25 +14,30 @@
 
 namespace
 {
-static const std::uint16_t indices[] = { 0, 1, 2, 1, 3, 2 };
-static const glm::vec2 units[] = {
-	{ 0.f, 0.f },
-	{ 0.f, 1.f },
-	{ 1.f, 0.f },
-	{ 1.f, 1.f },
-};
+// bytes of the regions of the streamed instance buffer at the start,
+// they grow to the largest layer
+static const std::size_t InstanceCapacity = 32 * 1024;
+
+// the pivot is stored in 1/PivotScale of the size
+static const float PivotScale = 254.f;
+
+std::uint16_t
+normalize(float value)
+{
+	return std::clamp(value, 0.f, 1.f) * UINT16_MAX + 0.5f;
+}
 }
 
 RenderTarget::RenderTarget()
 	: mTexture(nullptr)
-	, mVertexOffset(0)
-	, mVertexCount(0)
-	, mIndexOffset(0)
-	, mIndexCount(0)
-	, mVBO(0)
-	, mEBO(0)
+	, mInstanceOffset(0)
+	, mOffscreen(nullptr)
+	, mOffscreenSize(0.f)
+	, mOffscreenBatch(0)
+	, mOnscreenTexture(nullptr)
 	, mVAO(0)
 {
+	static_assert(sizeof(Instance) == 32, "An instance must fit 32 bytes");
 }
 
 RenderTarget::~RenderTarget()
@@ -41,14 +48,6 @@ RenderTarget::~RenderTarget()
 		glCheck(glBindVertexArray(0));
 		glCheck(glDeleteVertexArrays(1, &mVAO));
 	}
-	if (mEBO)
-	{
-		glCheck(glDeleteBuffers(1, &mEBO));
-	}
-	if (mVBO)
-	{
-		glCheck(glDeleteBuffers(1, &mVBO));
-	}
 }
 
 void
@@ -56,7 +55,7 @@ RenderTarget::create()
 {
 	mWhiteTexture.create(1, 1, &Color::White);
 	mShader.create();
-	if (!mShader.attachFile(Shader::Type::Vertex, "assets/shaders/pos_uv_color.vs")
+	if (!mShader.attachFile(Shader::Type::Vertex, "assets/shaders/sprite_instance.vs")
 	    || !mShader.attachFile(Shader::Type::Fragment, "assets/shaders/uv_color.fs")
 	    || !mShader.link())
 	{
@@ -68,28 +67,24 @@ RenderTarget::create()
 
 	glCheck(glEnable(GL_CULL_FACE));
 	glCheck(glEnable(GL_BLEND));
-	glCheck(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+	// the alpha accumulates so a texture drawn on an opaque one stays
+	// opaque once composited
+	glCheck(glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA,
+	                            GL_ONE, GL_ONE_MINUS_SRC_ALPHA));
 
-        // VBO and EBO
-	glCheck(glGenBuffers(1, &mEBO));
-	glCheck(glGenBuffers(1, &mVBO));
-	glCheck(glBindBuffer(GL_ARRAY_BUFFER, mVBO));
+	// the instances are streamed, the attributes point in the instance
+	// buffer on each draw
+	mInstanceBuffer.create(GL_ARRAY_BUFFER, InstanceCapacity);
 
-	// VAO
+	// VAO, every attribute advances once per instance and the corners
+	// of the quad come from the vertex index
 	glCheck(glGenVertexArrays(1, &mVAO));
 	glCheck(glBindVertexArray(mVAO));
-	glCheck(glEnableVertexAttribArray(0));
-	glCheck(glVertexAttribPointer(
-			0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-			reinterpret_cast<GLvoid*>(offsetof(Vertex, pos))));
-	glCheck(glEnableVertexAttribArray(1));
-	glCheck(glVertexAttribPointer(
-			1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-			reinterpret_cast<GLvoid*>(offsetof(Vertex, uv))));
-	glCheck(glEnableVertexAttribArray(2));
-	glCheck(glVertexAttribPointer(
-			2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex),
-			reinterpret_cast<GLvoid*>(offsetof(Vertex, color))));
+	for (unsigned attribute = 0; attribute < 6; attribute++)
+	{
+		glCheck(glEnableVertexAttribArray(attribute));
+		glCheck(glVertexAttribDivisor(attribute, 1));
+	}
 	glCheck(glBindVertexArray(0));
 }
 
@@ -99,8 +94,8 @@ RenderTarget::destroy()
 	mShader.destroy();
 	glCheck(glBindVertexArray(0));
 	glCheck(glDeleteVertexArrays(1, &mVAO));
-	glCheck(glDeleteBuffers(1, &mEBO));
-	glCheck(glDeleteBuffers(1, &mVBO));
+	mVAO = 0;
+	mInstanceBuffer.destroy();
 }
 
 void
@@ -145,11 +140,9 @@ void
 RenderTarget::beginRendering()
 {
 	mBatches.clear();
-	mVertices.clear();
-	mIndices.clear();
+	mInstances.clear();
 	mTexture = &mWhiteTexture;
-	mVertexOffset = mVertexCount = 0;
-	mIndexOffset = mIndexCount = 0;
+	mInstanceOffset = 0;
 }
 
 void
@@ -161,11 +154,9 @@ RenderTarget::newLayer()
 void
 RenderTarget::endRendering()
 {
-	mBatches.emplace_back(mTexture, mVertexOffset,
-	                      mIndexOffset*sizeof(mIndices[0]),
-	                      mIndexCount-mIndexOffset);
-	mVertexOffset = mVertexCount;
-	mIndexOffset = mIndexCount;
+	mBatches.emplace_back(mTexture, mInstanceOffset,
+	                      mInstances.size() - mInstanceOffset);
+	mInstanceOffset = mInstances.size();
 }
 
 void
@@ -175,7 +166,7 @@ RenderTarget::setTexture(const Texture *texture)
 	{
 		texture = &mWhiteTexture;
 	}
-	if (texture != mTexture && mIndexCount > mIndexOffset)
+	if (texture != mTexture && mInstances.size() > mInstanceOffset)
 	{
 		endRendering();
 	}
@@ -183,92 +174,140 @@ RenderTarget::setTexture(const Texture *texture)
 }
 
 void
-RenderTarget::reserve(unsigned vcount, std::span<const std::uint16_t> indices)
+RenderTarget::addSprite(const FloatRect &rect, glm::vec2 pos, glm::vec2 size, Color color,
+                        float angle, glm::vec2 pivot)
 {
-	auto base = mVertexCount - mVertexOffset;
-	if (base + vcount > UINT16_MAX)
-	{
-		endRendering();
-		base = 0;
-	}
-	mVertexCount += vcount;
-	for (auto i : indices)
-	{
-		mIndices.push_back(base + i);
-	}
-	mIndexCount += indices.size();
+	auto turns = angle / (2.f * 3.141592654f);
+	turns -= std::floor(turns);
+
+	auto &instance = mInstances.emplace_back();
+	instance.pos = pos;
+	instance.size = size;
+	instance.uvRect[0] = normalize(rect.pos.x);
+	instance.uvRect[1] = normalize(rect.pos.y);
+	instance.uvRect[2] = normalize(rect.pos.x + rect.size.x);
+	instance.uvRect[3] = normalize(rect.pos.y + rect.size.y);
+	instance.color = color;
+	instance.angle = static_cast<std::uint32_t>(turns * (UINT16_MAX + 1) + 0.5f);
+	instance.pivot[0] = std::clamp(pivot.x, 0.f, 1.f) * PivotScale + 0.5f;
+	instance.pivot[1] = std::clamp(pivot.y, 0.f, 1.f) * PivotScale + 0.5f;
 }
 
 void
-RenderTarget::draw() const
+RenderTarget::setInstanceFormat(std::size_t offset)
 {
+	glCheck(glVertexAttribPointer(
+			0, 2, GL_FLOAT, GL_FALSE, sizeof(Instance),
+			reinterpret_cast<GLvoid*>(offset + offsetof(Instance, pos))));
+	glCheck(glVertexAttribPointer(
+			1, 2, GL_FLOAT, GL_FALSE, sizeof(Instance),
+			reinterpret_cast<GLvoid*>(offset + offsetof(Instance, size))));
+	glCheck(glVertexAttribPointer(
+			2, 4, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(Instance),
+			reinterpret_cast<GLvoid*>(offset + offsetof(Instance, uvRect))));
+	glCheck(glVertexAttribPointer(
+			3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Instance),
+			reinterpret_cast<GLvoid*>(offset + offsetof(Instance, color))));
+	glCheck(glVertexAttribPointer(
+			4, 1, GL_UNSIGNED_SHORT, GL_FALSE, sizeof(Instance),
+			reinterpret_cast<GLvoid*>(offset + offsetof(Instance, angle))));
+	glCheck(glVertexAttribPointer(
+			5, 2, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(Instance),
+			reinterpret_cast<GLvoid*>(offset + offsetof(Instance, pivot))));
+}
+
+void
+RenderTarget::draw()
+{
+	assert(!mOffscreen && "Offscreen rendering not ended");
+	drawBatches(0);
+}
+
+void
+RenderTarget::beginOffscreen(RenderTexture &texture, glm::vec2 size)
+{
+	assert(!mOffscreen && "Offscreen rendering already begun");
+
+	endRendering();
+	mOffscreen = &texture;
+	mOffscreenSize = size;
+	mOffscreenBatch = mBatches.size();
+	mOnscreenTexture = mTexture;
+}
+
+void
+RenderTarget::endOffscreen()
+{
+	assert(mOffscreen && "Offscreen rendering not begun");
+
+	endRendering();
+
+	GLint viewport[4];
+	glCheck(glGetIntegerv(GL_VIEWPORT, viewport));
+
+	auto size = mOffscreen->getSize();
+	Camera camera(mOffscreenSize * 0.5f, mOffscreenSize);
+	mOffscreen->bind();
+	glCheck(glViewport(0, 0, size.x, size.y));
 	mShader.use();
+	mShader.getUniform("projection").setMatrix4(camera.getTransform());
+	clear(Color::Transparent);
+	drawBatches(mOffscreenBatch);
 
-	glCheck(glBindVertexArray(mVAO));
-	glCheck(glBindBuffer(GL_ARRAY_BUFFER, mVBO));
-	glCheck(glBufferData(GL_ARRAY_BUFFER,
-	                     mVertices.size() * sizeof(mVertices[0]),
-	                     mVertices.data(),
-	                     GL_STREAM_DRAW));
-
-	glCheck(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEBO));
-	glCheck(glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-	                     mIndices.size() * sizeof(mIndices[0]),
-	                     mIndices.data(),
-	                     GL_STREAM_DRAW));
-
-	for (const auto &batch : mBatches)
-	{
-		batch.texture->bind(0);
-		glCheck(glDrawElementsBaseVertex(
-			        GL_TRIANGLES,
-			        batch.indexCount,
-			        GL_UNSIGNED_SHORT,
-			        reinterpret_cast<GLvoid*>(batch.indexOffset),
-			        batch.vertexOffset));
-	}
+	glCheck(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0));
+	glCheck(glViewport(viewport[0], viewport[1], viewport[2], viewport[3]));
+	mShader.getUniform("projection").setMatrix4(mCamera.getTransform());
 
-	glCheck(glBindVertexArray(0));
+	// the frame goes on where it was
+	mInstances.resize(mBatches[mOffscreenBatch].instanceOffset);
+	mBatches.resize(mOffscreenBatch);
+	mInstanceOffset = mInstances.size();
+	mTexture = mOnscreenTexture;
+	mOffscreen = nullptr;
 }
 
 void
-RenderTarget::draw(const std::string &text, glm::vec2 pos, Font &font, Color color)
+RenderTarget::drawBatches(std::size_t firstBatch)
 {
-	if (text.empty())
+	if (firstBatch == mBatches.size())
 	{
 		return;
 	}
 
-	auto codepoints = Utility::decodeUTF8(text);
-	for (auto codepoint : codepoints)
-	{
-		font.getGlyph(codepoint);
-	}
+	mShader.use();
 
-	setTexture(&font.getTexture());
-	pos.y += font.getLineHeight();
-	for (auto codepoint : codepoints)
+	glCheck(glBindVertexArray(mVAO));
+	auto first = mBatches[firstBatch].instanceOffset;
+	auto offset = mInstanceBuffer.write(
+		mInstances.data() + first,
+		(mInstances.size() - first) * sizeof(mInstances[0]));
+
+	// without base instance in GL 3.3 the attributes point at the
+	// first instance of each batch
+	for (auto i = firstBatch; i < mBatches.size(); i++)
 	{
-		reserve(4, indices);
-
-		const auto &glyph = font.getGlyph(codepoint);
-		pos.x += glyph.bearing.x;
-		pos.y -= glyph.bearing.y;
-		for (auto unit : units)
+		const auto &batch = mBatches[i];
+		if (batch.instanceCount == 0)
 		{
-			Vertex v;
-			v.pos = glyph.size * unit + pos;
-			v.uv = glyph.uvSize * unit + glyph.uvPos;
-			v.color = color;
-			mVertices.push_back(v);
+			continue;
 		}
-		pos.x += glyph.advance - glyph.bearing.x;
-		pos.y += glyph.bearing.y;
+		batch.texture->bind(0);
+		setInstanceFormat(offset + (batch.instanceOffset - first) * sizeof(Instance));
+		glCheck(glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, batch.instanceCount));
 	}
+
+	mInstanceBuffer.lock();
+	glCheck(glBindVertexArray(0));
+}
+
+void
+RenderTarget::draw(const std::string &text, glm::vec2 pos, Font &font, Color color)
+{
+	draw(text, pos, 1.f, font, color);
 }
 
 void
-RenderTarget::draw(const std::string &text, const glm::mat4 &transform, Font &font, Color color)
+RenderTarget::draw(const std::string &text, glm::vec2 pos, float scale, Font &font, Color color)
 {
 	if (text.empty())
 	{
@@ -283,25 +322,17 @@ RenderTarget::draw(const std::string &text, const glm::mat4 &transform, Font &fo
 
 	setTexture(&font.getTexture());
 
-	glm::vec2 pos(0.f);
-	pos.y += font.getLineHeight();
+	// the pen moves unscaled, each glyph is scaled from the origin
+	glm::vec2 pen(0.f, font.getLineHeight());
 	for (auto codepoint : codepoints)
 	{
-		reserve(4, indices);
 		const auto &glyph = font.getGlyph(codepoint);
-		pos.x += glyph.bearing.x;
-		pos.y -= glyph.bearing.y;
-		for (auto unit : units)
-		{
-			Vertex v;
-			v.pos = glm::vec2(
-				transform * glm::vec4(glyph.size * unit + pos, 0.f, 1.f));
-			v.uv = glyph.uvSize * unit + glyph.uvPos;
-			v.color = color;
-			mVertices.push_back(v);
-		}
-		pos.x += glyph.advance - glyph.bearing.x;
-		pos.y += glyph.bearing.y;
+		pen.x += glyph.bearing.x;
+		pen.y -= glyph.bearing.y;
+		addSprite({ glyph.uvPos, glyph.uvSize }, pen * scale + pos,
+		          glyph.size * scale, color);
+		pen.x += glyph.advance - glyph.bearing.x;
+		pen.y += glyph.bearing.y;
 	}
 }
 
@@ -309,56 +340,25 @@ void
 RenderTarget::draw(const Texture &texture, glm::vec2 pos, glm::vec2 size)
 {
 	setTexture(&texture);
-	reserve(4, indices);
-	for (auto unit : units)
-	{
-		Vertex v;
-		v.pos = unit * size + pos;
-		v.uv = unit;
-		v.color = Color::White;
-		mVertices.push_back(v);
-	}
+	addSprite({ glm::vec2(0.f), glm::vec2(1.f) }, pos, size, Color::White);
 }
 
 void
 RenderTarget::draw(glm::vec2 pos, glm::vec2 size, Color color)
 {
 	setTexture(&mWhiteTexture);
-	reserve(4, indices);
-	for (auto unit : units)
-	{
-		Vertex v;
-		v.pos = unit * size + pos;
-		v.uv = unit;
-		v.color = color;
-		mVertices.push_back(v);
-	}
+	addSprite({ glm::vec2(0.f), glm::vec2(1.f) }, pos, size, color);
 }
 
 void
 RenderTarget::draw(const FloatRect &rect, glm::vec2 pos, glm::vec2 size, Color color)
 {
-	reserve(4, indices);
-	for (auto unit : units)
-	{
-		Vertex v;
-		v.pos = unit * size + pos;
-		v.uv = unit * rect.size + rect.pos;
-		v.color = color;
-		mVertices.push_back(v);
-	}
+	addSprite(rect, pos, size, color);
 }
 
 void
-RenderTarget::draw(const FloatRect &rect, const glm::mat4 &transform, glm::vec2 size, Color color)
+RenderTarget::draw(const FloatRect &rect, glm::vec2 pos, glm::vec2 size,
+                   float angle, glm::vec2 pivot, Color color)
 {
-	reserve(4, indices);
-	for (auto unit : units)
-	{
-		Vertex v;
-		v.pos = glm::vec2(transform * glm::vec4(unit * size, 0.f, 1.f));
-		v.uv = unit * rect.size + rect.pos;
-		v.color = color;
-		mVertices.push_back(v);
-	}
+	addSprite(rect, pos, size, color, angle, pivot);
 }
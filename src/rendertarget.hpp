@@ -1,13 +1,14 @@
 #pragma once
 
-#include <span>
 #include <unordered_map>
 #include <vector>
 
 #include "color.hpp"
+#include "rendertexture.hpp"
 #include "shader.hpp"
 #include "texture.hpp"
 #include "camera.hpp"
+#include "streambuffer.hpp"
 
 class Canvas;
 class Font;
@@ -57,22 +58,51 @@ public:
 	void use(const Window &window);
 
 	void draw(const std::string &text, glm::vec2 pos, Font &font, Color color);
-	void draw(const std::string &text, const glm::mat4 &transform, Font &font, Color color);
+
+	/**
+	 * Draw the @text scaled by @scale, its top left corner at @pos.
+	 */
+	void draw(const std::string &text, glm::vec2 pos, float scale, Font &font, Color color);
 	void draw(const Texture &texture, glm::vec2 pos, glm::vec2 size);
 	void draw(const FloatRect &rect, glm::vec2 pos, glm::vec2 size, Color color=Color::White);
-	void draw(const FloatRect &rect, const glm::mat4 &transform, glm::vec2 size, Color color=Color::White);
+
+	/**
+	 * Draw the @rect of the texture rotated counterclockwise by
+	 * @angle radians around the @pivot, in fractions of the @size.
+	 */
+	void draw(const FloatRect &rect, glm::vec2 pos, glm::vec2 size,
+	          float angle, glm::vec2 pivot, Color color=Color::White);
 	void draw(glm::vec2 pos, glm::vec2 size, Color color);
 
 	void beginRendering();
 	void newLayer();
 	void endRendering();
-	void draw() const;
+	void draw();
+
+	/**
+	 * Send the next primitives to the @texture instead, the ones
+	 * before keep their place in the frame.
+	 *
+	 * @param size The area, in the units of the primitives,
+	 *             stretched over the whole texture.
+	 */
+	void beginOffscreen(RenderTexture &texture, glm::vec2 size);
+
+	/**
+	 * Clear the texture given to beginOffscreen() and draw the
+	 * primitives sent to it.
+	 */
+	void endOffscreen();
 
 protected:
 	void initialize();
 
 private:
-	void reserve(unsigned vcount, std::span<const std::uint16_t> indices);
+	void addSprite(const FloatRect &rect, glm::vec2 pos, glm::vec2 size, Color color,
+	               float angle = 0.f, glm::vec2 pivot = glm::vec2(0.f));
+	void setInstanceFormat(std::size_t offset);
+	void drawBatches(std::size_t firstBatch);
+
 private:
 	Camera mDefaultCamera;
 	Camera mCamera;
@@ -80,31 +110,36 @@ private:
 	struct Batch
 	{
 		const Texture *texture;
-		unsigned vertexOffset;
-		unsigned indexOffset;
-		unsigned indexCount;
+		unsigned instanceOffset;
+		unsigned instanceCount;
 	};
 
-	struct Vertex
+	// a sprite, the vertex shader expands it to a quad: the texture
+	// rectangle corners are normalized, the angle is in 1/65536 of a
+	// turn and the pivot in 1/254 of the size, exact at the center
+	struct Instance
 	{
 		glm::vec2 pos;
-		glm::vec2 uv;
+		glm::vec2 size;
+		std::uint16_t uvRect[4];
 		std::uint32_t color;
+		std::uint16_t angle;
+		std::uint8_t pivot[2];
 	};
 
 	std::vector<Batch> mBatches;
-	std::vector<Vertex> mVertices;
-	std::vector<std::uint16_t> mIndices;
+	std::vector<Instance> mInstances;
 
 	const Texture *mTexture;
-	unsigned mVertexOffset;
-	unsigned mVertexCount;
-	unsigned mIndexOffset;
-	unsigned mIndexCount;
+	unsigned mInstanceOffset;
+
+	RenderTexture *mOffscreen;
+	glm::vec2 mOffscreenSize;
+	std::size_t mOffscreenBatch;
+	const Texture *mOnscreenTexture;
 
 	Texture       mWhiteTexture;
 	Shader        mShader;
-	unsigned      mVBO;
-	unsigned      mEBO;
+	StreamBuffer  mInstanceBuffer;
 	unsigned      mVAO;
 };
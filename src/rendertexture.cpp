@@ -0,0 +1,89 @@
+#include <stdexcept>
+
+#include <GL/glew.h>
+
+#include "glcheck.hpp"
+#include "rendertexture.hpp"
+
+RenderTexture::RenderTexture()
+	: mTexture()
+	, mFramebuffer(0)
+	, mSize(0)
+{
+}
+
+RenderTexture::~RenderTexture()
+{
+	destroy();
+}
+
+void
+RenderTexture::create(glm::ivec2 size)
+{
+	destroy();
+	if (!mTexture.create(size.x, size.y))
+	{
+		throw std::runtime_error("RenderTexture::create() - cannot create the texture");
+	}
+	mSize = size;
+
+	GLint oldFramebuffer;
+	glCheck(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &oldFramebuffer));
+
+	glCheck(glGenFramebuffers(1, &mFramebuffer));
+	glCheck(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mFramebuffer));
+	glCheck(glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER,
+				       GL_COLOR_ATTACHMENT0,
+				       GL_TEXTURE_2D,
+				       mTexture.getHandle(),
+				       0));
+	GLenum status = glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER);
+	glCheck(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, oldFramebuffer));
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		destroy();
+		throw std::runtime_error("RenderTexture::create() - framebuffer not complete");
+	}
+}
+
+void
+RenderTexture::destroy()
+{
+	if (mFramebuffer)
+	{
+		glCheck(glDeleteFramebuffers(1, &mFramebuffer));
+		mFramebuffer = 0;
+	}
+	mTexture.destroy();
+	mSize = glm::ivec2(0);
+}
+
+bool
+RenderTexture::isCreated() const
+{
+	return mFramebuffer != 0;
+}
+
+glm::ivec2
+RenderTexture::getSize() const
+{
+	return mSize;
+}
+
+const Texture&
+RenderTexture::getTexture() const
+{
+	return mTexture;
+}
+
+FloatRect
+RenderTexture::getTextureRect() const
+{
+	return { glm::vec2(0.f, 1.f), glm::vec2(1.f, -1.f) };
+}
+
+void
+RenderTexture::bind() const
+{
+	glCheck(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mFramebuffer));
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "rect.hpp"
+#include "texture.hpp"
+
+/**
+ * Texture with a framebuffer object, the RenderTarget draws in it
+ * between beginOffscreen() and endOffscreen().
+ */
+class RenderTexture
+{
+public:
+	RenderTexture();
+	~RenderTexture();
+
+	RenderTexture(const RenderTexture &) = delete;
+	RenderTexture& operator=(const RenderTexture &) = delete;
+
+	/**
+	 * @throw std::runtime_error if the framebuffer isn't complete.
+	 */
+	void create(glm::ivec2 size);
+	void destroy();
+
+	bool isCreated() const;
+	glm::ivec2 getSize() const;
+	const Texture& getTexture() const;
+
+	/**
+	 * Get the texture rectangle drawing the content upright, the
+	 * framebuffer stores its rows bottom up.
+	 */
+	FloatRect getTextureRect() const;
+
+	/**
+	 * Bind the framebuffer as the target of the draws.
+	 */
+	void bind() const;
+
+private:
+	Texture mTexture;
+	unsigned mFramebuffer;
+	glm::ivec2 mSize;
+};
@@ -0,0 +1,344 @@
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include "replay.hpp"
+
+namespace
+{
+
+static const char Magic[4] = { 'F', 'C', 'R', 'P' };
+// the version 1 has no checksums, the version 2 no level seeds
+static const std::uint64_t Version = 3;
+
+void
+writeVarint(std::string &out, std::uint64_t value)
+{
+	for (; value >= 0x80; value >>= 7)
+	{
+		out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+	}
+	out.push_back(static_cast<char>(value));
+}
+
+class Reader
+{
+public:
+	explicit Reader(const std::string &data)
+		: mData(data)
+		, mOffset(0)
+	{
+	}
+
+	std::uint32_t readWord()
+	{
+		std::uint32_t value = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			value |= static_cast<std::uint32_t>(readByte()) << (i * 8);
+		}
+		return value;
+	}
+
+	std::uint8_t readByte()
+	{
+		if (mOffset >= mData.size())
+		{
+			throw std::runtime_error("Truncated replay");
+		}
+		return static_cast<std::uint8_t>(mData[mOffset++]);
+	}
+
+	std::uint64_t readVarint()
+	{
+		std::uint64_t value = 0;
+		for (int shift = 0; shift < 64; shift += 7)
+		{
+			auto byte = readByte();
+			value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+			if (!(byte & 0x80))
+			{
+				return value;
+			}
+		}
+		throw std::runtime_error("Invalid varint in replay");
+	}
+
+	bool atEnd() const
+	{
+		return mOffset == mData.size();
+	}
+
+private:
+	const std::string &mData;
+	std::size_t mOffset;
+};
+
+}
+
+Replay::Replay()
+	: Replay(0, 0.f)
+{
+}
+
+Replay::Replay(std::uint64_t seed, float step)
+	: mSeed(seed)
+	, mStep(step)
+	, mTickCount(0)
+	, mInputs()
+	, mChecksums()
+	, mLevelSeeds()
+{
+}
+
+std::uint64_t
+Replay::getSeed() const
+{
+	return mSeed;
+}
+
+float
+Replay::getStep() const
+{
+	return mStep;
+}
+
+long
+Replay::getTickCount() const
+{
+	return mTickCount;
+}
+
+std::span<const Replay::Input>
+Replay::getInputs() const
+{
+	return mInputs;
+}
+
+std::span<const std::uint32_t>
+Replay::getChecksums() const
+{
+	return mChecksums;
+}
+
+std::span<const std::uint64_t>
+Replay::getLevelSeeds() const
+{
+	return mLevelSeeds;
+}
+
+void
+Replay::record(long tick, const GameState::Command &command)
+{
+	assert((mInputs.empty() || mInputs.back().tick < tick)
+	       && "The commands must be recorded in order");
+
+	mInputs.push_back({tick, command});
+	mTickCount = std::max(mTickCount, tick + 1);
+}
+
+void
+Replay::recordChecksum(std::uint32_t checksum)
+{
+	mChecksums.push_back(checksum);
+	mTickCount = std::max<long>(mTickCount, mChecksums.size());
+}
+
+void
+Replay::setTickCount(long ticks)
+{
+	assert((mInputs.empty() || mInputs.back().tick < ticks)
+	       && "The replay must contain its commands");
+	assert((mChecksums.empty() || static_cast<long>(mChecksums.size()) == ticks)
+	       && "Every step must have a checksum");
+
+	mTickCount = ticks;
+}
+
+void
+Replay::setLevelSeeds(std::span<const std::uint64_t> seeds)
+{
+	mLevelSeeds.assign(seeds.begin(), seeds.end());
+}
+
+void
+Replay::truncate(long tick)
+{
+	while (!mInputs.empty() && mInputs.back().tick >= tick)
+	{
+		mInputs.pop_back();
+	}
+	if (static_cast<long>(mChecksums.size()) > tick)
+	{
+		mChecksums.resize(tick);
+	}
+	mTickCount = std::min(mTickCount, tick);
+}
+
+GameState
+Replay::play() const
+{
+	GameState state(mSeed);
+	state.setLevelSeeds(mLevelSeeds);
+	std::size_t nextInput = 0;
+	for (long tick = 0; tick < mTickCount && !state.isGameOver(); tick++)
+	{
+		step(state, tick, nextInput);
+	}
+	return state;
+}
+
+bool
+Replay::findDivergence(Divergence &divergence) const
+{
+	GameState state(mSeed);
+	state.setLevelSeeds(mLevelSeeds);
+	std::size_t nextInput = 0;
+	long tickCount = mChecksums.size();
+	for (long tick = 0; tick < tickCount && !state.isGameOver(); tick++)
+	{
+		state.saveSnapshot(divergence.previous);
+		step(state, tick, nextInput);
+		if (state.getChecksum() != mChecksums[tick])
+		{
+			divergence.tick = tick;
+			state.saveSnapshot(divergence.state);
+			return true;
+		}
+	}
+	return false;
+}
+
+void
+Replay::step(GameState &state, long tick, std::size_t &nextInput) const
+{
+	const GameState::Command *command = nullptr;
+	if (nextInput < mInputs.size() && mInputs[nextInput].tick == tick)
+	{
+		command = &mInputs[nextInput++].command;
+	}
+	state.update(mStep, command);
+}
+
+void
+Replay::save(const std::filesystem::path &filename) const
+{
+	std::string data(Magic, sizeof(Magic));
+	writeVarint(data, Version);
+	writeVarint(data, mSeed);
+	writeVarint(data, std::bit_cast<std::uint32_t>(mStep));
+	writeVarint(data, mTickCount);
+	writeVarint(data, mInputs.size());
+
+	// the ticks are stored as the distance to the previous command
+	// and the cell with the direction in its low bit
+	long previous = 0;
+	for (const auto &input: mInputs)
+	{
+		const auto &command = input.command;
+		writeVarint(data, input.tick - previous);
+		writeVarint(data, (command.y * Board::BoardWidth + command.x) << 1
+		                  | command.clockwise);
+		previous = input.tick;
+	}
+
+	writeVarint(data, mChecksums.size());
+	for (auto checksum: mChecksums)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			data.push_back(static_cast<char>(checksum >> (i * 8)));
+		}
+	}
+
+	writeVarint(data, mLevelSeeds.size());
+	for (auto seed: mLevelSeeds)
+	{
+		writeVarint(data, seed);
+	}
+
+	std::ofstream out(filename, std::ios::binary);
+	out.write(data.data(), data.size());
+	if (!out)
+	{
+		throw std::runtime_error("Can't write the replay " + filename.string());
+	}
+}
+
+Replay
+Replay::load(const std::filesystem::path &filename)
+{
+	std::ifstream in(filename, std::ios::binary);
+	if (!in)
+	{
+		throw std::runtime_error(filename.string() + " not found.");
+	}
+	std::string data(std::istreambuf_iterator<char>(in), {});
+
+	Reader reader(data);
+	for (char c: Magic)
+	{
+		if (reader.readByte() != static_cast<std::uint8_t>(c))
+		{
+			throw std::runtime_error(filename.string() + " is not a replay");
+		}
+	}
+	auto version = reader.readVarint();
+	if (version < 1 || version > Version)
+	{
+		throw std::runtime_error("Unsupported version of the replay " + filename.string());
+	}
+
+	auto seed = reader.readVarint();
+	auto step = std::bit_cast<float>(static_cast<std::uint32_t>(reader.readVarint()));
+	Replay replay(seed, step);
+	auto tickCount = reader.readVarint();
+	auto inputCount = reader.readVarint();
+
+	long tick = 0;
+	for (std::uint64_t i = 0; i < inputCount; i++)
+	{
+		tick += reader.readVarint();
+		auto cell = reader.readVarint();
+		auto index = cell >> 1;
+		if (i > 0 && tick == replay.mInputs.back().tick)
+		{
+			throw std::runtime_error("Two commands on the same tick in " + filename.string());
+		}
+		if (index >= Board::BoardWidth * Board::BoardHeight)
+		{
+			throw std::runtime_error("Command out of the board in " + filename.string());
+		}
+		replay.mInputs.push_back({tick, {
+			static_cast<int>(index % Board::BoardWidth),
+			static_cast<int>(index / Board::BoardWidth),
+			(cell & 1) != 0,
+		}});
+	}
+	replay.mTickCount = tickCount;
+	auto checksumCount = version >= 2 ? reader.readVarint() : 0;
+	if (checksumCount != 0 && checksumCount != tickCount)
+	{
+		throw std::runtime_error("Missing checksums in " + filename.string());
+	}
+	for (std::uint64_t i = 0; i < checksumCount; i++)
+	{
+		replay.mChecksums.push_back(reader.readWord());
+	}
+	auto levelCount = version >= 3 ? reader.readVarint() : 0;
+	for (std::uint64_t i = 0; i < levelCount; i++)
+	{
+		replay.mLevelSeeds.push_back(reader.readVarint());
+	}
+
+	if (!reader.atEnd() || !(replay.mStep > 0.f)
+	    || (!replay.mInputs.empty() && replay.mTickCount <= tick))
+	{
+		throw std::runtime_error("Invalid replay " + filename.string());
+	}
+	return replay;
+}
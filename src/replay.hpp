@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "gamestate.hpp"
+
+/**
+ * Recording of a game: its seed, the length of its steps and the
+ * commands applied, indexed by the step they were applied on.
+ *
+ * The game is deterministic, so playing the commands back on the
+ * same steps gives the same game. The file is a "FCRP" magic followed
+ * by LEB128 varints, most commands take two bytes.
+ *
+ * The checksum of the state after each step can be recorded too, a
+ * playback then finds the first step where it doesn't match.
+ *
+ * The seeds of the level boards are recorded as well, the boards of
+ * a game depend on how soon the level generator found them.
+ */
+class Replay
+{
+public:
+	struct Input
+	{
+		long tick;
+		GameState::Command command;
+	};
+
+	struct Divergence
+	{
+		long tick;
+
+		// the state before the step, the last one matching the
+		// recording, and the state after it
+		GameState::Snapshot previous;
+		GameState::Snapshot state;
+	};
+
+public:
+	Replay();
+	Replay(std::uint64_t seed, float step);
+
+	std::uint64_t getSeed() const;
+	float getStep() const;
+	long getTickCount() const;
+	std::span<const Input> getInputs() const;
+	std::span<const std::uint32_t> getChecksums() const;
+	std::span<const std::uint64_t> getLevelSeeds() const;
+
+	/**
+	 * Record the @command applied on the step @tick, the ticks must
+	 * be recorded in order.
+	 */
+	void record(long tick, const GameState::Command &command);
+
+	/**
+	 * Record the checksum of the state after the next step, all
+	 * the steps or none must have one.
+	 */
+	void recordChecksum(std::uint32_t checksum);
+
+	/**
+	 * Set the number of steps of the game, at least one after the
+	 * last recorded command.
+	 */
+	void setTickCount(long ticks);
+
+	/**
+	 * Set the seeds of the level boards, from GameState::getLevelSeeds().
+	 */
+	void setLevelSeeds(std::span<const std::uint64_t> seeds);
+
+	/**
+	 * Drop the commands and the checksums from the step @tick on,
+	 * the game has been rewound to it.
+	 */
+	void truncate(long tick);
+
+	/**
+	 * Play the whole recording without rendering.
+	 *
+	 * @return The state after the last step or at the game over.
+	 */
+	GameState play() const;
+
+	/**
+	 * Play the recording until the checksum of a step doesn't
+	 * match the recorded one.
+	 *
+	 * @retval true the game diverged, the step is in @divergence.
+	 * @retval false the checksums match or there are none.
+	 */
+	bool findDivergence(Divergence &divergence) const;
+
+	void save(const std::filesystem::path &filename) const;
+
+	/**
+	 * @throw std::runtime_error if the file can't be read or isn't a
+	 *        replay.
+	 */
+	static Replay load(const std::filesystem::path &filename);
+
+private:
+	void step(GameState &state, long tick, std::size_t &nextInput) const;
+
+private:
+	std::uint64_t mSeed;
+	float mStep;
+	long mTickCount;
+	std::vector<Input> mInputs;
+	std::vector<std::uint32_t> mChecksums;
+	std::vector<std::uint64_t> mLevelSeeds;
+};
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+/**
+ * The last elements pushed, up to a fixed capacity.
+ *
+ * The storage is allocated once, a push over a full buffer reuses the
+ * slot of the oldest element, so pushing and popping are O(1) and
+ * never allocate. The elements are indexed from the oldest.
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+	explicit RingBuffer(std::size_t capacity = 0);
+
+	std::size_t getCapacity() const;
+	std::size_t getSize() const;
+	bool empty() const;
+	void clear();
+
+	/**
+	 * Get the slot of a new newest element, to be assigned in
+	 * place. The oldest element is dropped if the buffer is full.
+	 */
+	T& push();
+	void pop();
+
+	T& back();
+	const T& back() const;
+	const T& operator[](std::size_t index) const;
+
+private:
+	std::size_t getSlot(std::size_t index) const;
+
+private:
+	std::vector<T> mItems;
+	std::size_t mFirst;
+	std::size_t mSize;
+};
+
+template <typename T>
+RingBuffer<T>::RingBuffer(std::size_t capacity)
+	: mItems(capacity)
+	, mFirst(0)
+	, mSize(0)
+{
+}
+
+template <typename T>
+std::size_t
+RingBuffer<T>::getCapacity() const
+{
+	return mItems.size();
+}
+
+template <typename T>
+std::size_t
+RingBuffer<T>::getSize() const
+{
+	return mSize;
+}
+
+template <typename T>
+bool
+RingBuffer<T>::empty() const
+{
+	return mSize == 0;
+}
+
+template <typename T>
+void
+RingBuffer<T>::clear()
+{
+	mFirst = 0;
+	mSize = 0;
+}
+
+template <typename T>
+T&
+RingBuffer<T>::push()
+{
+	assert(!mItems.empty() && "Push to a buffer without capacity");
+
+	if (mSize == mItems.size())
+	{
+		mFirst = getSlot(1);
+	}
+	else
+	{
+		mSize++;
+	}
+	return mItems[getSlot(mSize - 1)];
+}
+
+template <typename T>
+void
+RingBuffer<T>::pop()
+{
+	assert(mSize > 0 && "Pop from an empty buffer");
+
+	mSize--;
+}
+
+template <typename T>
+T&
+RingBuffer<T>::back()
+{
+	assert(mSize > 0 && "Back of an empty buffer");
+
+	return mItems[getSlot(mSize - 1)];
+}
+
+template <typename T>
+const T&
+RingBuffer<T>::back() const
+{
+	assert(mSize > 0 && "Back of an empty buffer");
+
+	return mItems[getSlot(mSize - 1)];
+}
+
+template <typename T>
+const T&
+RingBuffer<T>::operator[](std::size_t index) const
+{
+	assert(index < mSize && "Index out of the buffer");
+
+	return mItems[getSlot(index)];
+}
+
+template <typename T>
+std::size_t
+RingBuffer<T>::getSlot(std::size_t index) const
+{
+	auto slot = mFirst + index;
+	return slot < mItems.size() ? slot : slot - mItems.size();
+}
@@ -1,32 +1,36 @@
+#include <cmath>
+
 #include "scorezoom.hpp"
 
 namespace
 {
-static const int mMaxDisplayCount = 30;
-static const float mScaleAmount = 0.4f;
+static const float DisplayTime = 0.5f;
+static const float ScaleSpeed = 24.f;
 }
 
 ScoreZoom::ScoreZoom(const std::string &text, Color color)
 	: text(text)
 	, drawColor(color)
-	, mDisplayCounter(0)
+	, mElapsed(0.f)
+	, mPreviousElapsed(0.f)
 {
 }
 
 float
-ScoreZoom::getScale() const
+ScoreZoom::getScale(float alpha) const
 {
-	return mScaleAmount * mDisplayCounter;
+	return ScaleSpeed * std::lerp(mPreviousElapsed, mElapsed, alpha);
 }
 
 bool
 ScoreZoom::isCompleted() const
 {
-	return mDisplayCounter > mMaxDisplayCount;
+	return mElapsed > DisplayTime;
 }
 
 void
-ScoreZoom::update(float)
+ScoreZoom::update(float dt)
 {
-	mDisplayCounter++;
+	mPreviousElapsed = mElapsed;
+	mElapsed += dt;
 }
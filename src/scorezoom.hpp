@@ -9,7 +9,12 @@ class ScoreZoom
 public:
 	ScoreZoom(const std::string &text, Color color);
 
-	float getScale() const;
+	/**
+	 * Get the scale interpolated between the last two updates.
+	 *
+	 * @param[in] alpha Fraction of the step since the last update.
+	 */
+	float getScale(float alpha = 1.f) const;
 	bool isCompleted() const;
 
 	void update(float dt);
@@ -19,5 +24,6 @@ public:
 	Color drawColor;
 
 private:
-	int mDisplayCounter;
+	float mElapsed;
+	float mPreviousElapsed;
 };
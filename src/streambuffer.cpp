@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+#include <GL/glew.h>
+
+#include "glcheck.hpp"
+#include "streambuffer.hpp"
+
+namespace
+{
+// the regions start on this alignment, enough for any attribute
+static const std::size_t MinCapacity = 256;
+
+// nanoseconds waited on a fence before flushing and waiting again
+static const GLuint64 WaitTimeout = 1000000000;
+
+static const GLbitfield MapFlags = GL_MAP_WRITE_BIT
+                                 | GL_MAP_PERSISTENT_BIT
+                                 | GL_MAP_COHERENT_BIT;
+}
+
+StreamBuffer::StreamBuffer()
+	: mTarget(0)
+	, mBuffer(0)
+	, mPersistent(false)
+	, mCapacity(0)
+	, mData(nullptr)
+	, mRegion(0)
+	, mFences()
+{
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	destroy();
+}
+
+void
+StreamBuffer::create(unsigned target, std::size_t capacity)
+{
+	destroy();
+	mTarget = target;
+	mPersistent = GLEW_ARB_buffer_storage;
+	allocate(capacity);
+}
+
+void
+StreamBuffer::destroy()
+{
+	if (mBuffer)
+	{
+		release();
+	}
+}
+
+bool
+StreamBuffer::isPersistent() const
+{
+	return mPersistent;
+}
+
+std::size_t
+StreamBuffer::write(const void *data, std::size_t size)
+{
+	if (!mPersistent)
+	{
+		glCheck(glBindBuffer(mTarget, mBuffer));
+		glCheck(glBufferData(mTarget, size, data, GL_STREAM_DRAW));
+		return 0;
+	}
+
+	if (size > mCapacity)
+	{
+		// the storage is immutable, a new one replaces it once the
+		// GPU is done with all the regions
+		release();
+		allocate(size);
+	}
+
+	mRegion = (mRegion + 1) % RegionCount;
+	wait(mRegion);
+
+	auto offset = mRegion * mCapacity;
+	std::memcpy(mData + offset, data, size);
+	glCheck(glBindBuffer(mTarget, mBuffer));
+	return offset;
+}
+
+void
+StreamBuffer::lock()
+{
+	if (!mPersistent)
+	{
+		return;
+	}
+
+	assert(!mFences[mRegion] && "Region already locked");
+	mFences[mRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void
+StreamBuffer::allocate(std::size_t capacity)
+{
+	mCapacity = std::bit_ceil(std::max(capacity, MinCapacity));
+	mRegion = 0;
+	glCheck(glGenBuffers(1, &mBuffer));
+	if (!mPersistent)
+	{
+		return;
+	}
+
+	auto size = mCapacity * RegionCount;
+	glCheck(glBindBuffer(mTarget, mBuffer));
+	glCheck(glBufferStorage(mTarget, size, nullptr, MapFlags));
+	mData = static_cast<std::byte*>(glMapBufferRange(mTarget, 0, size, MapFlags));
+	if (!mData)
+	{
+		throw std::runtime_error("StreamBuffer::allocate() - mapping failed");
+	}
+}
+
+void
+StreamBuffer::release()
+{
+	for (int i = 0; i < RegionCount; i++)
+	{
+		wait(i);
+	}
+	if (mData)
+	{
+		glCheck(glBindBuffer(mTarget, mBuffer));
+		glCheck(glUnmapBuffer(mTarget));
+		mData = nullptr;
+	}
+	glCheck(glDeleteBuffers(1, &mBuffer));
+	mBuffer = 0;
+}
+
+void
+StreamBuffer::wait(int region)
+{
+	auto &fence = mFences[region];
+	if (!fence)
+	{
+		return;
+	}
+
+	GLenum status;
+	do
+	{
+		status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, WaitTimeout);
+	} while (status == GL_TIMEOUT_EXPIRED);
+
+	glCheck(glDeleteSync(fence));
+	fence = nullptr;
+	if (status == GL_WAIT_FAILED)
+	{
+		throw std::runtime_error("StreamBuffer::wait() - fence wait failed");
+	}
+}
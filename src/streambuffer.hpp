@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+
+typedef struct __GLsync *GLsync;
+
+/**
+ * Buffer object with data written anew for every draw.
+ *
+ * With ARB_buffer_storage the buffer is mapped once for good and split
+ * in RegionCount regions written in turn, the data is copied straight
+ * to the memory read by the GPU. A fence after the draws reading a
+ * region tells when it can be written again, so the CPU only waits
+ * when it runs RegionCount draws ahead of the GPU.
+ *
+ * Without the extension the buffer is re-specified by glBufferData on
+ * each write.
+ */
+class StreamBuffer
+{
+public:
+	StreamBuffer();
+	~StreamBuffer();
+
+	StreamBuffer(const StreamBuffer &) = delete;
+	StreamBuffer& operator=(const StreamBuffer &) = delete;
+
+	/**
+	 * Create the buffer for the GL @target, with regions of
+	 * @capacity bytes grown by the writes that don't fit.
+	 */
+	void create(unsigned target, std::size_t capacity);
+	void destroy();
+
+	bool isPersistent() const;
+
+	/**
+	 * Copy @size bytes of @data to the next region and bind the
+	 * buffer to its target.
+	 *
+	 * @return The offset of the data in the buffer.
+	 */
+	std::size_t write(const void *data, std::size_t size);
+
+	/**
+	 * Fence the region of the last write, once the draws reading
+	 * it are issued.
+	 */
+	void lock();
+
+private:
+	static constexpr int RegionCount = 3;
+
+	void allocate(std::size_t capacity);
+	void release();
+	void wait(int region);
+
+private:
+	unsigned mTarget;
+	unsigned mBuffer;
+	bool mPersistent;
+	std::size_t mCapacity;
+	std::byte *mData;
+	int mRegion;
+	GLsync mFences[RegionCount];
+};
@@ -0,0 +1,392 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FLOODCONTROL_X86
+#include <immintrin.h>
+#endif
+
+#include "successorevaluator.hpp"
+
+namespace
+{
+
+static const std::uint64_t LowBits = 0x0101010101010101ULL;
+static const std::uint64_t NotHighBits = 0x7F7F7F7F7F7F7F7FULL;
+
+std::uint64_t
+load64(const std::uint8_t *bytes)
+{
+	std::uint64_t value;
+	std::memcpy(&value, bytes, sizeof(value));
+	return value;
+}
+
+bool
+isStraight(unsigned connectors)
+{
+	return connectors == (Pipe::Left | Pipe::Right)
+		|| connectors == (Pipe::Top | Pipe::Bottom);
+}
+
+#ifdef FLOODCONTROL_X86
+
+__attribute__((target("sse2"))) inline __m128i
+load128(const std::uint8_t *bytes)
+{
+	return _mm_load_si128(reinterpret_cast<const __m128i*>(bytes));
+}
+
+__attribute__((target("avx2"))) inline __m256i
+load256(const std::uint8_t *bytes)
+{
+	return _mm256_load_si256(reinterpret_cast<const __m256i*>(bytes));
+}
+
+#endif
+
+}
+
+SuccessorEvaluator::SuccessorEvaluator()
+	: SuccessorEvaluator(detectKernel())
+{
+}
+
+SuccessorEvaluator::SuccessorEvaluator(Kernel kernel)
+	: mKernel(kernel)
+	, mFlood(floodPortable)
+	, mBlockSize(8)
+	, mLanes(std::make_unique<Lanes>())
+	, mSuccessors()
+{
+	switch (kernel)
+	{
+	case Portable:
+		break;
+	case Sse2:
+		mFlood = floodSse2;
+		mBlockSize = 16;
+		break;
+	case Avx2:
+		mFlood = floodAvx2;
+		mBlockSize = 32;
+		break;
+	}
+	mSuccessors.reserve(LaneCount);
+}
+
+SuccessorEvaluator::Kernel
+SuccessorEvaluator::getKernel() const
+{
+	return mKernel;
+}
+
+SuccessorEvaluator::Kernel
+SuccessorEvaluator::detectKernel()
+{
+#ifdef FLOODCONTROL_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+	{
+		return Avx2;
+	}
+	if (__builtin_cpu_supports("sse2"))
+	{
+		return Sse2;
+	}
+#endif
+	return Portable;
+}
+
+std::span<const SuccessorEvaluator::Successor>
+SuccessorEvaluator::evaluate(const Board &board, bool halfTurns)
+{
+	return evaluate(board.getBitBoard(), halfTurns);
+}
+
+std::span<const SuccessorEvaluator::Successor>
+SuccessorEvaluator::evaluate(const BitBoard<Board::BoardWidth, Board::BoardHeight> &bits,
+                             bool halfTurns)
+{
+	auto &lanes = *mLanes;
+
+	std::uint8_t base[4][Height] = {};
+	for (int y = 0; y < Height; y++)
+	{
+		for (int x = 0; x < Board::BoardWidth; x++)
+		{
+			auto connectors = bits.getConnectors(x, y);
+			for (int i = 0; i < 4; i++)
+			{
+				base[i][y] |= ((connectors >> i) & 1) << x;
+			}
+		}
+	}
+	for (int i = 0; i < 4; i++)
+	{
+		for (int y = 0; y < Height; y++)
+		{
+			std::memset(lanes.planes[i][y], base[i][y], LaneCount);
+		}
+	}
+
+	// every successor differs from the board in a single byte
+	// of each plane
+	mSuccessors.clear();
+	for (int y = 0; y < Height; y++)
+	{
+		for (int x = 0; x < Board::BoardWidth; x++)
+		{
+			auto connectors = bits.getConnectors(x, y);
+			if (connectors == 0)
+			{
+				continue;
+			}
+
+			// the straight pipes look the same both ways, and
+			// the same after a half turn
+			bool straight = isStraight(connectors);
+			int turns = halfTurns && !straight ? 3 : 2;
+			for (int turn = straight; turn < turns; turn++)
+			{
+				int lane = mSuccessors.size();
+				bool clockwise = turn != 0;
+				auto rotated = BitBoard<Board::BoardWidth, Height>::rotateConnectors(
+					connectors, clockwise);
+				if (turn == 2)
+				{
+					rotated = BitBoard<Board::BoardWidth, Height>::rotateConnectors(
+						rotated, clockwise);
+				}
+				for (int i = 0; i < 4; i++)
+				{
+					lanes.planes[i][y][lane] = (base[i][y] & ~(1 << x))
+						| ((rotated >> i) & 1) << x;
+				}
+				mSuccessors.push_back({{x, y, clockwise}, 0, turn == 2});
+			}
+		}
+	}
+
+	// the water of a row that scores can't reach the left edge
+	// again, so the rows can be flooded one by one without
+	// excluding the cells of the previous chains
+	int count = mSuccessors.size();
+	for (int row = 0; row < Height; row++)
+	{
+		for (int lane = 0; lane < count; lane += mBlockSize)
+		{
+			auto exits = mFlood(lanes, row, lane);
+			for (; exits; exits &= exits - 1)
+			{
+				int index = lane + std::countr_zero(exits);
+				if (index >= count)
+				{
+					break;
+				}
+
+				int size = 0;
+				for (int y = 0; y < Height; y++)
+				{
+					size += std::popcount(lanes.water[y][index]);
+				}
+				mSuccessors[index].score += GameState::determineScore(size);
+			}
+		}
+	}
+
+	std::stable_sort(mSuccessors.begin(), mSuccessors.end(),
+	                 [](const auto &a, const auto &b) { return a.score > b.score; });
+	return mSuccessors;
+}
+
+std::uint32_t
+SuccessorEvaluator::floodPortable(Lanes &lanes, int row, int lane)
+{
+	// bit x of horizontal[y] is set when the cell (x, y) is
+	// connected to (x+1, y), of vertical[y] when it is connected
+	// to (x, y+1)
+	std::uint64_t horizontal[Height], vertical[Height], water[Height];
+	for (int y = 0; y < Height; y++)
+	{
+		auto left = load64(&lanes.planes[1][y][lane]);
+		auto bottom = load64(&lanes.planes[2][y][lane]);
+		auto right = load64(&lanes.planes[3][y][lane]);
+		horizontal[y] = right & (left >> 1) & NotHighBits;
+		vertical[y] = y + 1 < Height
+			? bottom & load64(&lanes.planes[0][y + 1][lane])
+			: 0;
+		water[y] = 0;
+	}
+	water[row] = load64(&lanes.planes[1][row][lane]) & LowBits;
+
+	for (std::uint64_t changed = water[row]; changed;)
+	{
+		changed = 0;
+		for (int y = 0; y < Height; y++)
+		{
+			auto next = water[y]
+				| (water[y] & horizontal[y]) << 1
+				| ((water[y] >> 1) & horizontal[y]);
+			if (y > 0)
+			{
+				next |= water[y - 1] & vertical[y - 1];
+			}
+			if (y + 1 < Height)
+			{
+				next |= water[y + 1] & vertical[y];
+			}
+			changed |= next ^ water[y];
+			water[y] = next;
+		}
+	}
+
+	// the water leaves the board from the right connector of the
+	// last column, the high bit of each byte
+	std::uint64_t exit = 0;
+	for (int y = 0; y < Height; y++)
+	{
+		exit |= water[y] & load64(&lanes.planes[3][y][lane]);
+		std::memcpy(&lanes.water[y][lane], &water[y], sizeof(water[y]));
+	}
+
+	std::uint32_t exits = 0;
+	for (int i = 0; i < 8; i++)
+	{
+		exits |= ((exit >> (i * 8 + 7)) & 1) << i;
+	}
+	return exits;
+}
+
+#ifdef FLOODCONTROL_X86
+
+__attribute__((target("sse2"))) std::uint32_t
+SuccessorEvaluator::floodSse2(Lanes &lanes, int row, int lane)
+{
+	const auto lowBits = _mm_set1_epi8(1);
+	const auto notHighBits = _mm_set1_epi8(0x7F);
+	const auto zero = _mm_setzero_si128();
+
+	__m128i horizontal[Height], vertical[Height], water[Height];
+	for (int y = 0; y < Height; y++)
+	{
+		auto left = load128(&lanes.planes[1][y][lane]);
+		auto bottom = load128(&lanes.planes[2][y][lane]);
+		auto right = load128(&lanes.planes[3][y][lane]);
+		horizontal[y] = _mm_and_si128(right, _mm_srli_epi16(left, 1));
+		horizontal[y] = _mm_and_si128(horizontal[y], notHighBits);
+		vertical[y] = y + 1 < Height
+			? _mm_and_si128(bottom, load128(&lanes.planes[0][y + 1][lane]))
+			: zero;
+		water[y] = zero;
+	}
+	water[row] = _mm_and_si128(load128(&lanes.planes[1][row][lane]), lowBits);
+
+	for (bool changed = true; changed;)
+	{
+		auto difference = zero;
+		for (int y = 0; y < Height; y++)
+		{
+			// the byte shifts are done with an add and with
+			// 16-bit shifts, the bit crossing into the next
+			// byte is cleared by the connection mask
+			auto toRight = _mm_and_si128(water[y], horizontal[y]);
+			auto toLeft = _mm_and_si128(_mm_srli_epi16(water[y], 1), horizontal[y]);
+			auto next = _mm_or_si128(water[y], _mm_add_epi8(toRight, toRight));
+			next = _mm_or_si128(next, toLeft);
+			if (y > 0)
+			{
+				next = _mm_or_si128(next, _mm_and_si128(water[y - 1], vertical[y - 1]));
+			}
+			if (y + 1 < Height)
+			{
+				next = _mm_or_si128(next, _mm_and_si128(water[y + 1], vertical[y]));
+			}
+			difference = _mm_or_si128(difference, _mm_xor_si128(next, water[y]));
+			water[y] = next;
+		}
+		auto unchanged = _mm_cmpeq_epi8(difference, zero);
+		changed = _mm_movemask_epi8(unchanged) != 0xFFFF;
+	}
+
+	auto exit = zero;
+	for (int y = 0; y < Height; y++)
+	{
+		auto right = load128(&lanes.planes[3][y][lane]);
+		exit = _mm_or_si128(exit, _mm_and_si128(water[y], right));
+		_mm_store_si128(reinterpret_cast<__m128i*>(&lanes.water[y][lane]), water[y]);
+	}
+	return _mm_movemask_epi8(exit);
+}
+
+__attribute__((target("avx2"))) std::uint32_t
+SuccessorEvaluator::floodAvx2(Lanes &lanes, int row, int lane)
+{
+	const auto lowBits = _mm256_set1_epi8(1);
+	const auto notHighBits = _mm256_set1_epi8(0x7F);
+	const auto zero = _mm256_setzero_si256();
+
+	__m256i horizontal[Height], vertical[Height], water[Height];
+	for (int y = 0; y < Height; y++)
+	{
+		auto left = load256(&lanes.planes[1][y][lane]);
+		auto bottom = load256(&lanes.planes[2][y][lane]);
+		auto right = load256(&lanes.planes[3][y][lane]);
+		horizontal[y] = _mm256_and_si256(right, _mm256_srli_epi16(left, 1));
+		horizontal[y] = _mm256_and_si256(horizontal[y], notHighBits);
+		vertical[y] = y + 1 < Height
+			? _mm256_and_si256(bottom, load256(&lanes.planes[0][y + 1][lane]))
+			: zero;
+		water[y] = zero;
+	}
+	water[row] = _mm256_and_si256(load256(&lanes.planes[1][row][lane]), lowBits);
+
+	for (bool changed = true; changed;)
+	{
+		auto difference = zero;
+		for (int y = 0; y < Height; y++)
+		{
+			auto toRight = _mm256_and_si256(water[y], horizontal[y]);
+			auto toLeft = _mm256_and_si256(_mm256_srli_epi16(water[y], 1), horizontal[y]);
+			auto next = _mm256_or_si256(water[y], _mm256_add_epi8(toRight, toRight));
+			next = _mm256_or_si256(next, toLeft);
+			if (y > 0)
+			{
+				next = _mm256_or_si256(next, _mm256_and_si256(water[y - 1], vertical[y - 1]));
+			}
+			if (y + 1 < Height)
+			{
+				next = _mm256_or_si256(next, _mm256_and_si256(water[y + 1], vertical[y]));
+			}
+			difference = _mm256_or_si256(difference, _mm256_xor_si256(next, water[y]));
+			water[y] = next;
+		}
+		changed = !_mm256_testz_si256(difference, difference);
+	}
+
+	auto exit = zero;
+	for (int y = 0; y < Height; y++)
+	{
+		auto right = load256(&lanes.planes[3][y][lane]);
+		exit = _mm256_or_si256(exit, _mm256_and_si256(water[y], right));
+		_mm256_store_si256(reinterpret_cast<__m256i*>(&lanes.water[y][lane]), water[y]);
+	}
+	return _mm256_movemask_epi8(exit);
+}
+
+#else
+
+std::uint32_t
+SuccessorEvaluator::floodSse2(Lanes &lanes, int row, int lane)
+{
+	return floodPortable(lanes, row, lane) | floodPortable(lanes, row, lane + 8) << 8;
+}
+
+std::uint32_t
+SuccessorEvaluator::floodAvx2(Lanes &lanes, int row, int lane)
+{
+	return floodSse2(lanes, row, lane) | floodSse2(lanes, row, lane + 16) << 16;
+}
+
+#endif
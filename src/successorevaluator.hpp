@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "board.hpp"
+#include "gamestate.hpp"
+
+/**
+ * Immediate score of every board one rotation away from a Board.
+ *
+ * The board is packed with one byte per row of each connector plane
+ * and every successor gets its own byte lane, so one instruction
+ * moves the water of 32 successors with AVX2 or 16 with SSE2. The
+ * instruction set is chosen at runtime, the portable kernel does the
+ * same on 64-bit words.
+ */
+class SuccessorEvaluator
+{
+public:
+	struct Successor
+	{
+		GameState::Command command;
+		int score;
+
+		// the command is applied twice
+		bool halfTurn;
+	};
+
+	enum Kernel
+	{
+		Portable,
+		Sse2,
+		Avx2,
+	};
+
+public:
+	SuccessorEvaluator();
+	explicit SuccessorEvaluator(Kernel kernel);
+
+	Kernel getKernel() const;
+
+	/**
+	 * Best kernel supported by the CPU.
+	 */
+	static Kernel detectKernel();
+
+	/**
+	 * Evaluate all the single rotations of @board, and the half
+	 * turns of the bends if @halfTurns is set.
+	 *
+	 * @return The rotations sorted by decreasing score, the single
+	 *         rotations first among equal scores, valid until the
+	 *         next call.
+	 */
+	std::span<const Successor> evaluate(const Board &board, bool halfTurns = false);
+	std::span<const Successor> evaluate(const BitBoard<Board::BoardWidth, Board::BoardHeight> &board,
+	                                    bool halfTurns = false);
+
+private:
+	static_assert(Board::BoardWidth == 8, "A row of the board must fit a byte");
+
+	static constexpr int Height = Board::BoardHeight;
+
+	// three rotations per cell, rounded up to the widest block
+	static constexpr int LaneCount = (Board::BoardWidth * Board::BoardHeight * 3 + 31) / 32 * 32;
+
+	// the byte lanes of the connector planes, indexed like the
+	// Pipe::Direction bits, and of the water
+	struct Lanes
+	{
+		alignas(32) std::uint8_t planes[4][Height][LaneCount];
+		alignas(32) std::uint8_t water[Height][LaneCount];
+	};
+
+	typedef std::uint32_t (*FloodFunction)(Lanes &lanes, int row, int lane);
+
+	static std::uint32_t floodPortable(Lanes &lanes, int row, int lane);
+	static std::uint32_t floodSse2(Lanes &lanes, int row, int lane);
+	static std::uint32_t floodAvx2(Lanes &lanes, int row, int lane);
+
+private:
+	Kernel mKernel;
+	FloodFunction mFlood;
+	int mBlockSize;
+	std::unique_ptr<Lanes> mLanes;
+	std::vector<Successor> mSuccessors;
+};
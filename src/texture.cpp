@@ -255,6 +255,12 @@ Texture::setSmooth(bool smooth)
 	glCheck(glBindTexture(GL_TEXTURE_2D, 0));
 }
 
+unsigned
+Texture::getHandle() const
+{
+	return mTexture;
+}
+
 void
 Texture::bind() const
 {
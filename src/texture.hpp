@@ -34,6 +34,8 @@ public:
 	void bind() const;
 	void bind(int textureUnit) const noexcept;
 
+	unsigned getHandle() const;
+
 private:
 	unsigned mTexture = -1U;
 };
@@ -34,8 +34,20 @@ TitleView::handleEvent(const Event &event)
 	return false;
 }
 
+bool
+TitleView::hasChanged() const
+{
+	return false;
+}
+
+bool
+TitleView::needsUpdates() const
+{
+	return false;
+}
+
 void
-TitleView::render(RenderTarget &target)
+TitleView::render(RenderTarget &target, float)
 {
 	target.clear(Color::Black);
 	target.draw(mTexture, glm::vec2(0.f), mTextureSize);
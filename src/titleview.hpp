@@ -13,7 +13,9 @@ public:
 
 	virtual bool update(float dt) override;
 	virtual bool handleEvent(const Event &event) override;
-	virtual void render(RenderTarget &target) override;
+	virtual bool hasChanged() const override;
+	virtual bool needsUpdates() const override;
+	virtual void render(RenderTarget &target, float alpha) override;
 
 private:
 	ViewStack &mViewStack;
@@ -0,0 +1,55 @@
+#include "transpositiontable.hpp"
+
+namespace
+{
+
+// set in the data of the entries in use, the empty ones are zero
+static const std::uint64_t ValidBit = std::uint64_t(1) << 32;
+
+}
+
+TranspositionTable::TranspositionTable(unsigned sizeLog2)
+	: mSize(std::size_t(1) << sizeLog2)
+	, mEntries(new Entry[mSize])
+{
+	clear();
+}
+
+std::size_t
+TranspositionTable::getSize() const
+{
+	return mSize;
+}
+
+void
+TranspositionTable::clear()
+{
+	for (std::size_t i = 0; i < mSize; i++)
+	{
+		mEntries[i].check.store(0, std::memory_order_relaxed);
+		mEntries[i].data.store(0, std::memory_order_relaxed);
+	}
+}
+
+bool
+TranspositionTable::probe(std::uint64_t hash, int &value) const
+{
+	const auto &entry = mEntries[hash & (mSize - 1)];
+	auto check = entry.check.load(std::memory_order_relaxed);
+	auto data = entry.data.load(std::memory_order_relaxed);
+	if ((check ^ data) != hash || !(data & ValidBit))
+	{
+		return false;
+	}
+	value = static_cast<std::int32_t>(data & 0xFFFFFFFF);
+	return true;
+}
+
+void
+TranspositionTable::store(std::uint64_t hash, int value)
+{
+	auto &entry = mEntries[hash & (mSize - 1)];
+	auto data = static_cast<std::uint32_t>(value) | ValidBit;
+	entry.check.store(hash ^ data, std::memory_order_relaxed);
+	entry.data.store(data, std::memory_order_relaxed);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * Fixed-size cache of the values of the positions already evaluated,
+ * indexed by their Zobrist hash.
+ *
+ * It can be shared by concurrent search threads without locks: every
+ * entry is stored as the hash xored with the data plus the data, so
+ * an entry torn by two writers fails the check in probe() instead of
+ * returning the value of another position. A store always replaces
+ * the entry in its slot.
+ */
+class TranspositionTable
+{
+public:
+	/**
+	 * Create a table of 2^@sizeLog2 entries.
+	 */
+	explicit TranspositionTable(unsigned sizeLog2);
+
+	std::size_t getSize() const;
+	void clear();
+
+	/**
+	 * Look up the position with the @hash.
+	 *
+	 * @retval true @value has been set.
+	 * @retval false the position is not in the table.
+	 */
+	bool probe(std::uint64_t hash, int &value) const;
+	void store(std::uint64_t hash, int value);
+
+private:
+	struct Entry
+	{
+		std::atomic<std::uint64_t> check;
+		std::atomic<std::uint64_t> data;
+	};
+
+private:
+	std::size_t mSize;
+	std::unique_ptr<Entry[]> mEntries;
+};
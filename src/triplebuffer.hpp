@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+
+/**
+ * Lock-free handoff of the latest value from one writer thread to one
+ * reader thread.
+ *
+ * The writer fills its own buffer and publishes it by swapping it with
+ * the middle one, the reader takes the middle buffer only when a newer
+ * one has been published. Neither side ever waits for the other, the
+ * values published in between two reads are dropped.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+	TripleBuffer();
+
+	TripleBuffer(const TripleBuffer &) = delete;
+	TripleBuffer& operator=(const TripleBuffer &) = delete;
+
+	/**
+	 * Buffer of the writer, to be filled before publish().
+	 */
+	T& getWriteBuffer();
+	void publish();
+
+	/**
+	 * Take the last published buffer if it is newer than the one
+	 * read.
+	 *
+	 * @retval true the read buffer has changed.
+	 * @retval false nothing new has been published.
+	 */
+	bool update();
+	const T& getReadBuffer() const;
+
+	/**
+	 * Tell if a buffer newer than the one read has been published.
+	 */
+	bool hasUpdate() const;
+
+private:
+	static constexpr unsigned IndexMask = 0x3;
+	static constexpr unsigned FreshBit = 0x4;
+
+private:
+	T mBuffers[3];
+	unsigned mWrite;
+	std::atomic<unsigned> mMiddle;
+	unsigned mRead;
+};
+
+template <typename T>
+TripleBuffer<T>::TripleBuffer()
+	: mBuffers()
+	, mWrite(0)
+	, mMiddle(1)
+	, mRead(2)
+{
+}
+
+template <typename T>
+T&
+TripleBuffer<T>::getWriteBuffer()
+{
+	return mBuffers[mWrite];
+}
+
+template <typename T>
+void
+TripleBuffer<T>::publish()
+{
+	mWrite = mMiddle.exchange(mWrite | FreshBit, std::memory_order_acq_rel) & IndexMask;
+}
+
+template <typename T>
+bool
+TripleBuffer<T>::update()
+{
+	if (!(mMiddle.load(std::memory_order_relaxed) & FreshBit))
+	{
+		return false;
+	}
+	mRead = mMiddle.exchange(mRead, std::memory_order_acq_rel) & IndexMask;
+	return true;
+}
+
+template <typename T>
+const T&
+TripleBuffer<T>::getReadBuffer() const
+{
+	return mBuffers[mRead];
+}
+
+template <typename T>
+bool
+TripleBuffer<T>::hasUpdate() const
+{
+	return mMiddle.load(std::memory_order_relaxed) & FreshBit;
+}
@@ -1,5 +1,3 @@
-#include <ctime>
-#include <random>
 #include <fstream>
 #include <sstream>
 
@@ -7,13 +5,6 @@
 
 namespace
 {
-std::default_random_engine createRandomEngine()
-{
-	auto seed = static_cast<unsigned long>(std::time(nullptr));
-	return std::default_random_engine(seed);
-}
-auto randomEngine = createRandomEngine();
-
 // Copyright (c) 2008-2009 Bjoern Hoehrmann <bjoern@hoehrmann.de>
 // See http://bjoern.hoehrmann.de/utf-8/decoder/dfa/ for details.
 
@@ -67,12 +58,6 @@ std::string loadFile(const std::filesystem::path &file)
 	return buffer.str();
 }
 
-int randomInt(int exclusiveMax)
-{
-	std::uniform_int_distribution<> distr(0, exclusiveMax - 1);
-	return distr(randomEngine);
-}
-
 std::u32string decodeUTF8(std::string_view str)
 {
 	std::u32string out;
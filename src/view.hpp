@@ -44,10 +44,60 @@ public:
 	 */
 	virtual bool handleEvent(const Event &event) = 0;
 
+	/**
+	 * Tell if the view runs ahead of the real time.
+	 *
+	 * While the top view is fast-forwarding the application updates
+	 * the views as fast as it can and neither renders nor displays
+	 * them.
+	 */
+	virtual bool isFastForwarding() const;
+
+	/**
+	 * Tell if the output of render() changed since its last call.
+	 *
+	 * When no view changed and no event arrived the application
+	 * doesn't render the frame and waits for the events instead.
+	 */
+	virtual bool hasChanged() const;
+
+	/**
+	 * Tell if the view must be updated as the time passes.
+	 *
+	 * Only the top view is asked, the views below are updated only
+	 * if it lets them. When it has nothing to update and nothing to
+	 * render the application sleeps until an event.
+	 */
+	virtual bool needsUpdates() const;
+
 	/**
 	 * Render the view using the @target.
 	 *
+	 * The views are updated at a fixed rate that can be lower than
+	 * the display rate, the animations are drawn between their last
+	 * two updated states.
+	 *
 	 * @param[in] target Reference to a RenderTarget class.
+	 * @param[in] alpha Fraction of the update step elapsed since the
+	 *                  last update, in [0, 1].
 	 */
-	virtual void render(RenderTarget &target) = 0;
+	virtual void render(RenderTarget &target, float alpha) = 0;
 };
+
+inline bool
+View::isFastForwarding() const
+{
+	return false;
+}
+
+inline bool
+View::hasChanged() const
+{
+	return true;
+}
+
+inline bool
+View::needsUpdates() const
+{
+	return true;
+}
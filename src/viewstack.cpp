@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cassert>
 
 #include "viewstack.hpp"
@@ -5,6 +6,7 @@
 
 ViewStack::ViewStack(const Context &context)
 	: mContext(context)
+	, mStackChanged(false)
 {
 }
 
@@ -45,15 +47,16 @@ ViewStack::handleEvent(const Event &event)
 }
 
 void
-ViewStack::render(RenderTarget &target)
+ViewStack::render(RenderTarget &target, float alpha)
 {
 	for (auto &view: mStack)
 	{
 		target.beginRendering();
-		view->render(target);
+		view->render(target, alpha);
 		target.endRendering();
 		target.draw();
 	}
+	mStackChanged = false;
 }
 
 void
@@ -80,6 +83,26 @@ ViewStack::empty() const
 	return mStack.empty();
 }
 
+bool
+ViewStack::isFastForwarding() const
+{
+	return !mStack.empty() && mStack.back()->isFastForwarding();
+}
+
+bool
+ViewStack::needsUpdates() const
+{
+	return !mStack.empty() && mStack.back()->needsUpdates();
+}
+
+bool
+ViewStack::hasChanged() const
+{
+	return mStackChanged
+		|| std::any_of(mStack.begin(), mStack.end(),
+		               [](const auto &view) { return view->hasChanged(); });
+}
+
 View::Ptr
 ViewStack::createState(ViewID viewID)
 {
@@ -91,6 +114,10 @@ ViewStack::createState(ViewID viewID)
 void
 ViewStack::applyPendingChanges()
 {
+	if (!mPendingChanges.empty())
+	{
+		mStackChanged = true;
+	}
 	for (const auto &change: mPendingChanges)
 	{
 		switch (change.action)
@@ -19,13 +19,25 @@ public:
 
 	bool update(float dt);
 	bool handleEvent(const Event &event);
-	void render(RenderTarget &target);
+	void render(RenderTarget &target, float alpha);
 
 	void pushView(ViewID viewID);
 	void popView();
 	void clearStack();
 
 	bool empty() const;
+	bool isFastForwarding() const;
+
+	/**
+	 * Tell if a view or the stack itself changed since the last
+	 * render.
+	 */
+	bool hasChanged() const;
+
+	/**
+	 * Tell if the top view must be updated as the time passes.
+	 */
+	bool needsUpdates() const;
 
 private:
 	enum Action
@@ -46,6 +58,7 @@ private:
 	Context mContext;
 	std::vector<View::Ptr> mStack;
 	std::vector<PendingChange> mPendingChanges;
+	bool mStackChanged;
 	std::unordered_map<ViewID, std::function<View::Ptr()>> mFactories;
 };
 
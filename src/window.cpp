@@ -74,6 +74,14 @@ Window::getSize() const
 	return mSize;
 }
 
+glm::ivec2
+Window::getFramebufferSize() const
+{
+	glm::ivec2 size;
+	glfwGetFramebufferSize(mWindow, &size.x, &size.y);
+	return size;
+}
+
 bool
 Window::isKeyPressed(int key) const
 {
@@ -25,6 +25,12 @@ public:
 	void setTitle(const std::string &title);
 
 	glm::ivec2 getSize() const;
+
+	/**
+	 * Get the size in pixels of the framebuffer, larger than the
+	 * window size on high density screens.
+	 */
+	glm::ivec2 getFramebufferSize() const;
 	bool isKeyPressed(int key) const;
 	void getMouseState(double &x, double &y, unsigned &buttons);
 
@@ -0,0 +1,100 @@
+#include <chrono>
+#include <thread>
+
+#include "workstealingpool.hpp"
+
+WorkStealingPool::WorkStealingPool(unsigned threadCount)
+	: mThreadCount(threadCount > 0 ? threadCount : 1)
+	, mQueues()
+{
+	for (unsigned i = 0; i < mThreadCount; i++)
+	{
+		mQueues.push_back(std::make_unique<Queue>());
+	}
+}
+
+unsigned
+WorkStealingPool::getThreadCount() const
+{
+	return mThreadCount;
+}
+
+std::vector<WorkStealingPool::WorkerStats>
+WorkStealingPool::run(int taskCount, const Task &task)
+{
+	for (unsigned i = 0; i < mThreadCount; i++)
+	{
+		int first = static_cast<long>(taskCount) * i / mThreadCount;
+		int last = static_cast<long>(taskCount) * (i + 1) / mThreadCount;
+		for (int t = last - 1; t >= first; t--)
+		{
+			mQueues[i]->tasks.push_back(t);
+		}
+	}
+
+	std::vector<WorkerStats> stats(mThreadCount, WorkerStats{0, 0, 0.0});
+	std::vector<std::thread> threads;
+	for (unsigned i = 0; i < mThreadCount; i++)
+	{
+		threads.emplace_back([this, i, &task, &stats]() {
+			auto &workerStats = stats[i];
+			int current;
+			for (;;)
+			{
+				if (!popTask(i, current))
+				{
+					if (!stealTask(i, current))
+					{
+						break;
+					}
+					workerStats.steals++;
+				}
+
+				auto start = std::chrono::steady_clock::now();
+				task(current, i);
+				std::chrono::duration<double> elapsed =
+					std::chrono::steady_clock::now() - start;
+				workerStats.busyTime += elapsed.count();
+				workerStats.tasks++;
+			}
+		});
+	}
+	for (auto &thread: threads)
+	{
+		thread.join();
+	}
+	return stats;
+}
+
+bool
+WorkStealingPool::popTask(unsigned worker, int &task)
+{
+	auto &queue = *mQueues[worker];
+	std::lock_guard lock(queue.mutex);
+	if (queue.tasks.empty())
+	{
+		return false;
+	}
+	task = queue.tasks.back();
+	queue.tasks.pop_back();
+	return true;
+}
+
+bool
+WorkStealingPool::stealTask(unsigned worker, int &task)
+{
+	// the tasks don't spawn other tasks, so once every queue is
+	// empty there is nothing left to do
+	for (unsigned i = 1; i < mThreadCount; i++)
+	{
+		auto &queue = *mQueues[(worker + i) % mThreadCount];
+		std::lock_guard lock(queue.mutex);
+		if (!queue.tasks.empty())
+		{
+			task = queue.tasks.front();
+			queue.tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * Run a fixed set of independent tasks on a pool of threads.
+ *
+ * Every worker starts with a contiguous range of the tasks in its
+ * own queue and takes the next one from the back; when its queue is
+ * empty it steals from the front of the queue of another worker.
+ */
+class WorkStealingPool
+{
+public:
+	typedef std::function<void(int task, unsigned worker)> Task;
+
+	struct WorkerStats
+	{
+		int tasks;
+		int steals;
+		double busyTime;
+	};
+
+public:
+	explicit WorkStealingPool(unsigned threadCount);
+
+	unsigned getThreadCount() const;
+
+	/**
+	 * Run @task for every index in [0, taskCount) and wait for
+	 * all of them to complete.
+	 *
+	 * @return Statistics of each worker.
+	 */
+	std::vector<WorkerStats> run(int taskCount, const Task &task);
+
+private:
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<int> tasks;
+	};
+
+	bool popTask(unsigned worker, int &task);
+	bool stealTask(unsigned worker, int &task);
+
+private:
+	unsigned mThreadCount;
+	std::vector<std::unique_ptr<Queue>> mQueues;
+};